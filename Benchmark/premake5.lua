@@ -0,0 +1,74 @@
+project "Benchmark"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "off"
+
+	targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("%{wks.location}/bin-int/" .. outputdir .. "/%{prj.name}")
+
+	--The renderer loads its shaders relative to the VulkanTest folder
+	debugdir "%{wks.location}/VulkanTest"
+
+	files {
+		"src/**.h",
+		"src/**.cpp",
+		"%{wks.location}/VulkanTest/src/**.h",
+		"%{wks.location}/VulkanTest/src/**.cpp",
+		"%{wks.location}/VulkanTest/vendor/glm/glm/**.hpp",
+		"%{wks.location}/VulkanTest/vendor/glm/glm/**.inl",
+		"%{wks.location}/VulkanTest/shaders/*.vert",
+		"%{wks.location}/VulkanTest/shaders/*.frag"
+	}
+
+	removefiles {
+		"%{wks.location}/VulkanTest/src/Main.cpp"
+	}
+
+	defines {
+		"_CRT_SECURE_NO_WARNINGS",
+		"GLFW_INCLUDE_NONE",
+		"Vulkan"
+	}
+
+	includedirs {
+		"src",
+		"%{wks.location}/VulkanTest/src",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.GLFW}",
+		"%{IncludeDir.VulkanSDK}"
+	}
+
+	links {
+		"GLFW",
+		"%{Library.Vulkan}"
+	}
+
+	--Same shader build as VulkanTest, so the benchmark doesn't depend on that project having been built first
+	filter { "files:**/VulkanTest/shaders/*.vert", "files:not **/VulkanTest/shaders/shader.*" }
+		buildmessage "Compiling %{file.name}"
+		buildcommands { '"%{ShaderCompiler}" "%{file.relpath}" -o "%{file.directory}/%{file.basename}_vert.spv"' }
+		buildoutputs { "%{file.directory}/%{file.basename}_vert.spv" }
+
+	filter { "files:**/VulkanTest/shaders/*.frag", "files:not **/VulkanTest/shaders/shader.*" }
+		buildmessage "Compiling %{file.name}"
+		buildcommands { '"%{ShaderCompiler}" "%{file.relpath}" -o "%{file.directory}/%{file.basename}_frag.spv"' }
+		buildoutputs { "%{file.directory}/%{file.basename}_frag.spv" }
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		runtime "Debug"
+		symbols "on"
+		defines {
+			"DEBUG"
+		}
+
+	filter "configurations:Release"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		runtime "Release"
+		optimize "on"
@@ -0,0 +1,170 @@
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include "Application.h"
+
+static void WriteStats(std::ostream& stream, const char* name, const FrameTimeStats& stats) {
+    stream << "\"" << name << "\": { \"min\": " << stats.Min << ", \"mean\": " << stats.Mean
+        << ", \"p50\": " << stats.P50 << ", \"p95\": " << stats.P95 << ", \"p99\": " << stats.P99
+        << ", \"max\": " << stats.Max << ", \"samples\": " << stats.SampleCount << " }";
+}
+
+static void WriteString(std::ostream& stream, const std::string& string) {
+    stream << "\"";
+    for (char c : string) {
+        if (c == '"' || c == '\\')
+            stream << '\\';
+        stream << c;
+    }
+    stream << "\"";
+}
+
+BenchmarkResult BenchmarkRunner::Run(BenchmarkScene& scene) {
+    using Clock = std::chrono::steady_clock;
+
+    BenchmarkResult result{};
+    result.Scene = scene.GetName();
+    result.Count = scene.GetCount();
+
+    Clock::time_point setupStart = Clock::now();
+    try {
+        scene.Setup();
+    }
+    catch (const std::exception& e) {
+        result.Error = e.what();
+        scene.Teardown();
+        return result;
+    }
+    result.SetupTime = std::chrono::duration<double, std::milli>(Clock::now() - setupStart).count();
+    result.DrawCallsPerFrame = scene.GetDrawCallsPerFrame();
+
+    Window& window = Application::Get().GetWindow();
+    GpuProfiler& profiler = Renderer::GetGpuProfiler();
+
+    //GPU timings show up a few frames late, the ones still belonging to warmup frames are skipped
+    const uint32_t gpuLatency = Device::Get().GetFramesInFlight();
+    GpuScopeStats gpuFrame{};
+    uint64_t gpuSampleCount = profiler.GetScopeStats("Frame", gpuFrame) ? gpuFrame.SampleCount : 0;
+
+    std::vector<double> cpuSamples, gpuSamples;
+    cpuSamples.reserve(m_MeasuredFrames);
+    gpuSamples.reserve(m_MeasuredFrames);
+
+    try {
+        for (uint32_t frame = 0; frame < m_WarmupFrames + m_MeasuredFrames; frame++) {
+            Clock::time_point frameStart = Clock::now();
+
+            Renderer::BeginScene();
+            scene.OnFrame();
+            Renderer::EndScene();
+
+            Renderer::DrawFrame();
+            window.OnRender();
+
+            double cpuFrameTime = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+            if (frame >= m_WarmupFrames)
+                cpuSamples.push_back(cpuFrameTime);
+
+            if (profiler.GetScopeStats("Frame", gpuFrame) && gpuFrame.SampleCount != gpuSampleCount) {
+                gpuSampleCount = gpuFrame.SampleCount;
+                if (frame >= m_WarmupFrames + gpuLatency)
+                    gpuSamples.push_back(gpuFrame.Last);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        //The scene is reported as failed, the ones after it still get their turn
+        result.Error = e.what();
+    }
+
+    //Buffers the scene owns may still be in use by the last frames
+    vkDeviceWaitIdle(Device::Get().GetDevice());
+    scene.Teardown();
+
+    if (!result.Error.empty())
+        return result;
+
+    result.CpuFrameTime = Summarize(cpuSamples);
+    result.GpuFrameTime = Summarize(gpuSamples);
+
+    double totalSeconds = 0.0;
+    for (double sample : cpuSamples)
+        totalSeconds += sample / 1000.0;
+
+    if (totalSeconds > 0.0)
+        result.DrawCallsPerSecond = result.DrawCallsPerFrame * cpuSamples.size() / totalSeconds;
+
+    return result;
+}
+
+FrameTimeStats BenchmarkRunner::Summarize(std::vector<double> samples) {
+    FrameTimeStats stats{};
+    stats.SampleCount = samples.size();
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+
+    auto percentile = [&samples](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+        return samples[(std::min)((std::max)(rank, (size_t)1), samples.size()) - 1];
+    };
+
+    stats.Min = samples.front();
+    stats.Max = samples.back();
+    stats.P50 = percentile(50.0);
+    stats.P95 = percentile(95.0);
+    stats.P99 = percentile(99.0);
+
+    for (double sample : samples)
+        stats.Mean += sample;
+    stats.Mean /= samples.size();
+
+    return stats;
+}
+
+void BenchmarkRunner::WriteJson(std::ostream& stream, const std::vector<BenchmarkResult>& results) const {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(Device::Get().GetPhysicalDevice(), &properties);
+
+    const Window& window = Application::Get().GetWindow();
+
+    stream << "{\n";
+    stream << "  \"device\": ";
+    WriteString(stream, properties.deviceName);
+    stream << ",\n";
+    stream << "  \"width\": " << window.GetWidth() << ",\n";
+    stream << "  \"height\": " << window.GetHeight() << ",\n";
+    stream << "  \"frames_in_flight\": " << Device::Get().GetFramesInFlight() << ",\n";
+    stream << "  \"warmup_frames\": " << m_WarmupFrames << ",\n";
+    stream << "  \"measured_frames\": " << m_MeasuredFrames << ",\n";
+    stream << "  \"scenes\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+
+        stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": ";
+        WriteString(stream, result.Scene);
+        stream << ", \"count\": " << result.Count;
+
+        if (!result.Error.empty()) {
+            stream << ", \"error\": ";
+            WriteString(stream, result.Error);
+            stream << " }";
+            continue;
+        }
+
+        stream << ", \"setup_ms\": " << result.SetupTime << ",\n      ";
+        WriteStats(stream, "cpu_ms", result.CpuFrameTime);
+        stream << ",\n      ";
+        WriteStats(stream, "gpu_ms", result.GpuFrameTime);
+        stream << ",\n      \"draw_calls_per_frame\": " << result.DrawCallsPerFrame
+            << ", \"draw_calls_per_second\": " << result.DrawCallsPerSecond << " }";
+    }
+
+    stream << "\n  ]\n}\n";
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "BenchmarkScene.h"
+
+//All times in milliseconds, percentiles use the nearest rank
+struct FrameTimeStats {
+	double Min = 0.0;
+	double Mean = 0.0;
+	double P50 = 0.0;
+	double P95 = 0.0;
+	double P99 = 0.0;
+	double Max = 0.0;
+
+	size_t SampleCount = 0;
+};
+
+struct BenchmarkResult {
+	std::string Scene;
+	uint32_t Count = 0;
+
+	//Set when the scene couldn't run, everything else is left empty then
+	std::string Error;
+
+	double SetupTime = 0.0;
+	FrameTimeStats CpuFrameTime;
+	FrameTimeStats GpuFrameTime;
+
+	uint32_t DrawCallsPerFrame = 0;
+	double DrawCallsPerSecond = 0.0;
+};
+
+//Renders a scene for WarmupFrames untimed frames, then MeasuredFrames timed ones. The CPU time of a frame is
+//from the start of the scene to the end of presenting it, which includes waiting for a free frame slot, so at a
+//steady state it is the frame interval. GPU time is the renderer's "Frame" timestamp scope.
+class BenchmarkRunner {
+public:
+	BenchmarkRunner(uint32_t warmupFrames, uint32_t measuredFrames)
+		: m_WarmupFrames(warmupFrames), m_MeasuredFrames(measuredFrames) {}
+
+	BenchmarkResult Run(BenchmarkScene& scene);
+
+	static FrameTimeStats Summarize(std::vector<double> samples);
+	void WriteJson(std::ostream& stream, const std::vector<BenchmarkResult>& results) const;
+private:
+	uint32_t m_WarmupFrames;
+	uint32_t m_MeasuredFrames;
+};
+
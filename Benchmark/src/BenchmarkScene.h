@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+//A fixed workload the runner renders for a set number of frames. Setup and Teardown run outside the timed frames.
+class BenchmarkScene {
+public:
+	BenchmarkScene(uint32_t count)
+		: m_Count(count) {}
+	virtual ~BenchmarkScene() = default;
+
+	virtual const char* GetName() const = 0;
+
+	virtual void Setup() {}
+	virtual void Teardown() {}
+
+	//Called between Renderer::BeginScene and Renderer::EndScene
+	virtual void OnFrame() = 0;
+
+	virtual uint32_t GetDrawCallsPerFrame() const = 0;
+
+	uint32_t GetCount() const { return m_Count; }
+protected:
+	uint32_t m_Count;
+};
+
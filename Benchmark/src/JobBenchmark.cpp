@@ -0,0 +1,182 @@
+#include "JobBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <iostream>
+#include <stdexcept>
+
+#include "Core/JobSystem.h"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename Function>
+JobBenchmarkResult JobBenchmark::Measure(const char* name, uint32_t threads, uint32_t count, Function&& function) {
+    JobSystem& jobSystem = JobSystem::Get();
+
+    std::vector<double> samples;
+    uint64_t stolen = 0;
+
+    for (uint32_t repetition = 0; repetition < m_Repetitions; repetition++) {
+        jobSystem.ResetStats();
+
+        Clock::time_point start = Clock::now();
+        function();
+        samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+        stolen += jobSystem.GetStats().JobsStolen;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    JobBenchmarkResult result{};
+    result.Name = name;
+    result.Threads = threads;
+    result.Count = count;
+    result.Time = samples[samples.size() / 2];
+    result.NanosecondsPerJob = result.Time * 1e6 / count;
+    result.JobsStolen = stolen / m_Repetitions;
+
+    return result;
+}
+
+std::vector<JobBenchmarkResult> JobBenchmark::Run(const std::vector<uint32_t>& threadCounts) {
+    JobSystem& jobSystem = JobSystem::Get();
+    std::vector<JobBenchmarkResult> results;
+
+    std::vector<float> elements(m_ElementCount);
+    for (uint32_t i = 0; i < m_ElementCount; i++)
+        elements[i] = static_cast<float>(i % 1024);
+
+    //What parallel_for is compared against, the loop without any jobs
+    double checksum = 0.0;
+    std::vector<double> baselineSamples;
+    for (uint32_t repetition = 0; repetition < m_Repetitions; repetition++) {
+        Clock::time_point start = Clock::now();
+
+        double sum = 0.0;
+        for (uint32_t i = 0; i < m_ElementCount; i++)
+            sum += std::sqrt(elements[i]);
+        checksum += sum;
+
+        baselineSamples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    std::sort(baselineSamples.begin(), baselineSamples.end());
+    const double baseline = baselineSamples[baselineSamples.size() / 2];
+
+    for (uint32_t threads : threadCounts) {
+        std::cerr << "job system with " << threads << " threads" << std::endl;
+
+        //A single thread is the job system without workers, every job runs inline
+        if (threads > 1)
+            jobSystem.Init(threads - 1);
+
+        results.push_back(Measure("spawn", threads, m_JobCount, [&]() {
+            JobCounter counter;
+            for (uint32_t i = 0; i < m_JobCount; i++)
+                jobSystem.Run([]() {}, &counter);
+            jobSystem.Wait(counter);
+        }));
+
+        //Needs a worker to queue the jobs, without one it would measure the same thing as spawn
+        if (threads > 1) {
+            bool parentOnWorker = true;
+            results.push_back(Measure("steal", threads, m_JobCount, [&]() {
+                JobCounter counter;
+                jobSystem.Run([&]() {
+                    if (!jobSystem.IsWorkerThread()) {
+                        parentOnWorker = false;
+                        return;
+                    }
+
+                    JobCounter children;
+                    for (uint32_t i = 0; i < m_JobCount; i++)
+                        jobSystem.Run([]() {}, &children);
+                    jobSystem.Wait(children);
+                }, &counter);
+
+                //Wait would let the main thread pick up the parent itself, a worker has to steal it instead
+                while (!counter.IsDone())
+                    std::this_thread::yield();
+                jobSystem.Wait(counter);
+            }));
+
+            if (!parentOnWorker) {
+                throw std::runtime_error("steal benchmark: the parent job didn't run on a worker!");
+            }
+        }
+
+        results.push_back(Measure("dependency_chain", threads, m_JobCount, [&]() {
+            std::vector<JobCounter> counters(m_JobCount);
+            jobSystem.Run([]() {}, &counters[0]);
+            for (uint32_t i = 1; i < m_JobCount; i++)
+                jobSystem.RunAfter(counters[i - 1], []() {}, &counters[i]);
+            jobSystem.Wait(counters.back());
+        }));
+
+        JobBenchmarkResult parallelFor = Measure("parallel_for", threads, m_ElementCount, [&]() {
+            //There are only a few ranges per thread, so locking once per range doesn't show up
+            std::mutex mutex;
+            double total = 0.0;
+
+            JobCounter counter;
+            jobSystem.ParallelFor(m_ElementCount, 4096, [&](uint32_t begin, uint32_t end) {
+                double sum = 0.0;
+                for (uint32_t i = begin; i < end; i++)
+                    sum += std::sqrt(elements[i]);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                total += sum;
+            }, &counter);
+            jobSystem.Wait(counter);
+
+            checksum += total;
+        });
+        parallelFor.Speedup = baseline / parallelFor.Time;
+        results.push_back(parallelFor);
+
+        if (threads > 1)
+            jobSystem.Shutdown();
+    }
+
+    //Keeps the loops from being optimized away
+    if (checksum < 0.0)
+        std::cerr << checksum << std::endl;
+
+    return results;
+}
+
+void JobBenchmark::WriteJson(std::ostream& stream, const std::vector<JobBenchmarkResult>& results) const {
+    stream << "{\n";
+    stream << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    stream << "  \"repetitions\": " << m_Repetitions << ",\n";
+    stream << "  \"jobs\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const JobBenchmarkResult& result = results[i];
+
+        stream << (i == 0 ? "\n" : ",\n") << "    { \"name\": \"" << result.Name << "\", \"threads\": " << result.Threads
+            << ", \"count\": " << result.Count << ", \"ms\": " << result.Time << ", \"ns_per_job\": " << result.NanosecondsPerJob
+            << ", \"jobs_stolen\": " << result.JobsStolen;
+
+        if (result.Speedup > 0.0)
+            stream << ", \"speedup\": " << result.Speedup;
+
+        stream << " }";
+    }
+
+    stream << "\n  ]\n}\n";
+}
+
+std::vector<uint32_t> JobBenchmark::GetDefaultThreadCounts() {
+    const uint32_t hardwareThreads = (std::max)(1u, std::thread::hardware_concurrency());
+
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < hardwareThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(hardwareThreads);
+
+    return threadCounts;
+}
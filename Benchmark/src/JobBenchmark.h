@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+struct JobBenchmarkResult {
+	const char* Name = "";
+
+	//Job system workers plus the thread submitting and waiting
+	uint32_t Threads = 0;
+	uint32_t Count = 0;
+
+	//Median over the repetitions, in milliseconds
+	double Time = 0.0;
+	double NanosecondsPerJob = 0.0;
+
+	//Only for parallel_for, relative to the same loop on a single thread
+	double Speedup = 0.0;
+
+	uint64_t JobsStolen = 0;
+};
+
+//Microbenchmarks of the job system's overhead, run without a renderer. The job system is started again with
+//every thread count, so it must not be initialized when Run is called.
+//  spawn            the main thread queues Count empty jobs and waits on them, the workers steal them
+//  steal            a worker queues Count empty jobs into its own deque, the other threads steal them
+//  dependency_chain Count empty jobs where each one is only queued once the one before has finished
+//  parallel_for     a memory bound loop over Count elements split across all threads
+class JobBenchmark {
+public:
+	JobBenchmark(uint32_t jobCount, uint32_t elementCount, uint32_t repetitions)
+		: m_JobCount(jobCount), m_ElementCount(elementCount), m_Repetitions(repetitions) {}
+
+	std::vector<JobBenchmarkResult> Run(const std::vector<uint32_t>& threadCounts);
+	void WriteJson(std::ostream& stream, const std::vector<JobBenchmarkResult>& results) const;
+
+	//Powers of two up to the hardware thread count, and the hardware thread count itself
+	static std::vector<uint32_t> GetDefaultThreadCounts();
+private:
+	template<typename Function>
+	JobBenchmarkResult Measure(const char* name, uint32_t threads, uint32_t count, Function&& function);
+private:
+	uint32_t m_JobCount;
+	uint32_t m_ElementCount;
+	uint32_t m_Repetitions;
+};
@@ -0,0 +1,152 @@
+#include "Application.h"
+#include "BenchmarkRunner.h"
+#include "Scenes.h"
+#include "JobBenchmark.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+//Has to run from the VulkanTest folder so the shaders are found. On machines without a GPU the software
+//rasterizer (lavapipe / SwiftShader) scores lowest but is still picked, set VULKAN_TEST_DEVICE to force a device.
+static void PrintUsage() {
+    std::cout << "usage: Benchmark [--frames N] [--warmup N] [--width N] [--height N] [--frames-in-flight N]\n"
+        << "                 [--job-threads N] [--recording-threads N]\n"
+        << "                 [--quads N] [--instances N] [--objects N] [--pipelines N]\n"
+        << "                 [--scene quads|instanced|uniforms|push_constants|textures|textures_no_mips|textures_ktx2|pipelines]... [--output benchmark.json]\n"
+        << "       Benchmark --jobs [--job-count N] [--repetitions N] [--output jobs.json]\n";
+}
+
+static uint32_t ParseCount(const char* value) {
+    return static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+}
+
+int main(int argc, char** argv) {
+    ApplicationSpecification specification;
+    specification.Name = "Benchmark";
+    specification.Headless = true;
+    specification.Width = 1280;
+    specification.Height = 720;
+
+    uint32_t warmupFrames = 100;
+    uint32_t measuredFrames = 500;
+    uint32_t quadCount = 10000;
+    uint32_t instanceCount = 10000;
+    uint32_t objectCount = 10000;
+    uint32_t pipelineCount = 24;
+    std::vector<std::string> sceneFilter;
+
+    bool jobBenchmarks = false;
+    uint32_t jobCount = 100000;
+    uint32_t repetitions = 10;
+    //Not stdout, the renderer logs there
+    std::string outputPath = "benchmark.json";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            measuredFrames = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            warmupFrames = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+            specification.Width = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc)
+            specification.Height = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+            specification.FramesInFlight = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--job-threads") == 0 && i + 1 < argc)
+            specification.JobThreads = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--jobs") == 0)
+            jobBenchmarks = true;
+        else if (strcmp(argv[i], "--job-count") == 0 && i + 1 < argc)
+            jobCount = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+            repetitions = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--recording-threads") == 0 && i + 1 < argc)
+            specification.RecordingThreads = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--quads") == 0 && i + 1 < argc)
+            quadCount = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+            instanceCount = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--objects") == 0 && i + 1 < argc)
+            objectCount = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--pipelines") == 0 && i + 1 < argc)
+            pipelineCount = ParseCount(argv[++i]);
+        else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            sceneFilter.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else {
+            PrintUsage();
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (specification.FramesInFlight < 1 || specification.FramesInFlight > Device::MAX_FRAMES_IN_FLIGHT) {
+        std::cerr << "--frames-in-flight must be between 1 and " << Device::MAX_FRAMES_IN_FLIGHT << std::endl;
+        PrintUsage();
+        return 1;
+    }
+
+    //The job system microbenchmarks don't need a device, they run instead of the scenes
+    if (jobBenchmarks) {
+        JobBenchmark benchmark(jobCount, 1u << 24, (std::max)(repetitions, 1u));
+        std::vector<JobBenchmarkResult> results = benchmark.Run(JobBenchmark::GetDefaultThreadCounts());
+
+        std::ofstream file(outputPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "failed to write " << outputPath << std::endl;
+            return 1;
+        }
+
+        benchmark.WriteJson(file, results);
+        std::cerr << "results written to " << outputPath << std::endl;
+        return 0;
+    }
+
+    Application app(specification);
+
+    std::vector<std::unique_ptr<BenchmarkScene>> scenes;
+    scenes.push_back(std::make_unique<QuadScene>(quadCount));
+    scenes.push_back(std::make_unique<InstancedScene>(instanceCount));
+    scenes.push_back(std::make_unique<UniformScene>(objectCount));
+    scenes.push_back(std::make_unique<PushConstantScene>(objectCount));
+    scenes.push_back(std::make_unique<TextureScene>(objectCount, TextureSceneMode::Mipmapped));
+    scenes.push_back(std::make_unique<TextureScene>(objectCount, TextureSceneMode::NoMips));
+
+    //BC formats are optional, devices without them would fail the whole run
+    if (Texture::IsFormatSupported(TextureFormat::BC1_RGB))
+        scenes.push_back(std::make_unique<TextureScene>(objectCount, TextureSceneMode::CompressedKtx2));
+    else
+        std::cerr << "skipping textures_ktx2, the device can't sample BC1" << std::endl;
+    scenes.push_back(std::make_unique<PipelineScene>(pipelineCount));
+
+    BenchmarkRunner runner(warmupFrames, measuredFrames);
+    std::vector<BenchmarkResult> results;
+    bool failed = false;
+
+    for (auto& scene : scenes) {
+        if (!sceneFilter.empty() && std::find(sceneFilter.begin(), sceneFilter.end(), scene->GetName()) == sceneFilter.end())
+            continue;
+
+        std::cerr << "running " << scene->GetName() << " (" << scene->GetCount() << ")" << std::endl;
+        results.push_back(runner.Run(*scene));
+
+        if (!results.back().Error.empty()) {
+            std::cerr << scene->GetName() << " failed: " << results.back().Error << std::endl;
+            failed = true;
+        }
+    }
+
+    std::ofstream file(outputPath, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "failed to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    runner.WriteJson(file, results);
+    std::cerr << "results written to " << outputPath << std::endl;
+
+    return failed ? 1 : 0;
+}
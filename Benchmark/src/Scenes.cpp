@@ -0,0 +1,589 @@
+#include "Scenes.h"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "Vulkan/VkRenderer.h"
+#include "Vulkan/VkTextureLoader.h"
+#include "Renderer/RenderCommand.h"
+
+//Lays count cells out in a square grid over the whole screen
+static uint32_t GetGridSize(uint32_t count) {
+    return (std::max)(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count)))));
+}
+
+static glm::vec2 GetGridPosition(uint32_t index, uint32_t gridSize) {
+    const float cellSize = 2.0f / gridSize;
+    return { -1.0f + (index % gridSize) * cellSize, -1.0f + (index / gridSize) * cellSize };
+}
+
+static std::shared_ptr<Buffer> CreateQuadIndexBuffer() {
+    const uint32_t indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    BufferDescription indexBufferDescription{};
+    indexBufferDescription.Type = BufferType::IndexBuffer;
+    indexBufferDescription.MemoryType = BufferMemoryType::DeviceLocal;
+    indexBufferDescription.Size = sizeof(indices);
+
+    std::shared_ptr<Buffer> indexBuffer = std::make_shared<Buffer>(indexBufferDescription);
+    indexBuffer->SetIndices(indices, 6);
+
+    return indexBuffer;
+}
+
+//The same unit quad for every draw, the per draw data moves it into its cell and tints it
+static std::shared_ptr<Buffer> CreateTintedQuadVertexBuffer() {
+    const QuadVertex vertices[] = {
+        { { 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } },
+        { { 1.0f, 0.0f }, { 1.0f, 1.0f, 1.0f } },
+        { { 1.0f, 1.0f }, { 0.8f, 0.8f, 0.8f } },
+        { { 0.0f, 1.0f }, { 0.8f, 0.8f, 0.8f } }
+    };
+
+    BufferDescription vertexBufferDescription{};
+    vertexBufferDescription.Type = BufferType::VertexBuffer;
+    vertexBufferDescription.MemoryType = BufferMemoryType::DeviceLocal;
+    vertexBufferDescription.Size = sizeof(vertices);
+
+    std::shared_ptr<Buffer> vertexBuffer = std::make_shared<Buffer>(vertexBufferDescription);
+    vertexBuffer->SetData(vertices, sizeof(vertices));
+
+    return vertexBuffer;
+}
+
+static std::vector<SceneObject> CreateSceneObjects(uint32_t count) {
+    const uint32_t gridSize = GetGridSize(count);
+    const float cellSize = 2.0f / gridSize;
+
+    std::vector<SceneObject> objects(count);
+    for (uint32_t i = 0; i < count; i++) {
+        glm::vec2 position = GetGridPosition(i, gridSize);
+
+        SceneObject& object = objects[i];
+        object.Model = glm::mat4(1.0f);
+        object.Model[0][0] = cellSize * 0.9f;
+        object.Model[1][1] = cellSize * 0.9f;
+        object.Model[3] = glm::vec4(position.x, position.y, 0.0f, 1.0f);
+        object.Color = glm::vec4((float)(i % gridSize) / gridSize, 0.5f, (float)(i / gridSize) / gridSize, 1.0f);
+    }
+
+    return objects;
+}
+
+void QuadScene::Setup() {
+    const uint32_t gridSize = GetGridSize(m_Count);
+    m_Size = glm::vec2(2.0f / gridSize * 0.9f);
+
+    m_Positions.resize(m_Count);
+    m_Colors.resize(m_Count);
+    for (uint32_t i = 0; i < m_Count; i++) {
+        m_Positions[i] = GetGridPosition(i, gridSize);
+        m_Colors[i] = { (float)(i % gridSize) / gridSize, (float)(i / gridSize) / gridSize, 1.0f };
+    }
+}
+
+void QuadScene::OnFrame() {
+    for (uint32_t i = 0; i < m_Count; i++)
+        Renderer::DrawQuad(m_Positions[i], m_Size, m_Colors[i]);
+}
+
+uint32_t QuadScene::GetDrawCallsPerFrame() const {
+    return (m_Count + RendererData::MaxQuads - 1) / RendererData::MaxQuads;
+}
+
+void InstancedScene::Setup() {
+    const uint32_t gridSize = GetGridSize(m_Count);
+    const float cellSize = 2.0f / gridSize;
+
+    //A unit quad at the origin, every instance moves and scales it into its cell
+    const QuadVertex vertices[] = {
+        { { 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } },
+        { { 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } },
+        { { 1.0f, 1.0f }, { 0.0f, 0.0f, 1.0f } },
+        { { 0.0f, 1.0f }, { 1.0f, 1.0f, 1.0f } }
+    };
+
+    BufferDescription vertexBufferDescription{};
+    vertexBufferDescription.Type = BufferType::VertexBuffer;
+    vertexBufferDescription.MemoryType = BufferMemoryType::DeviceLocal;
+    vertexBufferDescription.Size = sizeof(vertices);
+
+    m_VertexBuffer = std::make_shared<Buffer>(vertexBufferDescription);
+    m_VertexBuffer->SetData(vertices, sizeof(vertices));
+
+    m_IndexBuffer = CreateQuadIndexBuffer();
+
+    std::vector<glm::mat4> models(m_Count);
+    for (uint32_t i = 0; i < m_Count; i++) {
+        glm::vec2 position = GetGridPosition(i, gridSize);
+
+        glm::mat4 model(1.0f);
+        model[0][0] = cellSize * 0.9f;
+        model[1][1] = cellSize * 0.9f;
+        model[3] = glm::vec4(position.x, position.y, 0.0f, 1.0f);
+        models[i] = model;
+    }
+
+    BufferDescription instanceBufferDescription{};
+    instanceBufferDescription.Type = BufferType::VertexBuffer;
+    instanceBufferDescription.MemoryType = BufferMemoryType::DeviceLocal;
+    instanceBufferDescription.Size = models.size() * sizeof(glm::mat4);
+
+    m_InstanceBuffer = std::make_shared<Buffer>(instanceBufferDescription);
+    m_InstanceBuffer->SetData(models.data(), instanceBufferDescription.Size);
+
+    PipelineDescription pipelineDescription{};
+    pipelineDescription.Framebuffer = Renderer::GetFramebuffer();
+    pipelineDescription.Shaders = std::make_shared<Shader>((std::filesystem::path)"shaders/instanced_vert.spv", (std::filesystem::path)"shaders/frag.spv");
+    pipelineDescription.VertexLayouts = {
+        {
+            { ShaderDataType::Float2, "a_Position" },
+            { ShaderDataType::Float3, "a_Color" }
+        },
+        {
+            { ShaderDataType::Mat4, "a_Model", 1 }
+        }
+    };
+    pipelineDescription.DynamicStates = { DynamicStates::Viewport, DynamicStates::Scissor };
+
+    m_Pipeline = Renderer::GetPipeline(pipelineDescription);
+}
+
+void InstancedScene::Teardown() {
+    m_Pipeline.reset();
+    m_VertexBuffer.reset();
+    m_IndexBuffer.reset();
+    m_InstanceBuffer.reset();
+}
+
+void InstancedScene::OnFrame() {
+    Renderer::Submit([this](VkCommandBuffer commandBuffer) {
+        m_Pipeline->Bind(commandBuffer);
+        m_VertexBuffer->Bind(commandBuffer, 0);
+        m_InstanceBuffer->Bind(commandBuffer, 1);
+        m_IndexBuffer->Bind(commandBuffer);
+
+        RenderCommand::DrawIndexedInstanced(6, m_Count);
+    });
+}
+
+void UniformScene::Setup() {
+    UniformRingBuffer& uniformRing = Renderer::GetUniformRing();
+    //Every push takes the object's size rounded up to the alignment, not just the alignment
+    const VkDeviceSize alignment = uniformRing.GetAlignment();
+    const VkDeviceSize objectSize = (sizeof(SceneObject) + alignment - 1) / alignment * alignment;
+    if (m_Count * objectSize > uniformRing.GetFrameSize()) {
+        throw std::runtime_error("uniform scene doesn't fit into one frame of the uniform ring!");
+    }
+
+    m_VertexBuffer = CreateTintedQuadVertexBuffer();
+    m_IndexBuffer = CreateQuadIndexBuffer();
+    m_Objects = CreateSceneObjects(m_Count);
+
+    PipelineDescription pipelineDescription{};
+    pipelineDescription.Framebuffer = Renderer::GetFramebuffer();
+    pipelineDescription.Shaders = std::make_shared<Shader>((std::filesystem::path)"shaders/uniform_vert.spv", (std::filesystem::path)"shaders/frag.spv");
+    pipelineDescription.VertexLayouts = {
+        {
+            { ShaderDataType::Float2, "a_Position" },
+            { ShaderDataType::Float3, "a_Color" }
+        }
+    };
+    pipelineDescription.DescriptorSetLayouts = { uniformRing.GetLayout() };
+    pipelineDescription.DynamicStates = { DynamicStates::Viewport, DynamicStates::Scissor };
+
+    m_Pipeline = Renderer::GetPipeline(pipelineDescription);
+}
+
+void UniformScene::Teardown() {
+    m_Pipeline.reset();
+    m_VertexBuffer.reset();
+    m_IndexBuffer.reset();
+    m_Objects.clear();
+}
+
+void UniformScene::OnFrame() {
+    //Split up so the draws can be spread across recording threads
+    const uint32_t drawsPerCommand = 256;
+
+    for (uint32_t first = 0; first < m_Count; first += drawsPerCommand) {
+        Renderer::Submit([this, first, drawsPerCommand](VkCommandBuffer commandBuffer) {
+            UniformRingBuffer& uniformRing = Renderer::GetUniformRing();
+
+            m_Pipeline->Bind(commandBuffer);
+            m_VertexBuffer->Bind(commandBuffer, 0);
+            m_IndexBuffer->Bind(commandBuffer);
+
+            const uint32_t last = (std::min)(first + drawsPerCommand, m_Count);
+            for (uint32_t i = first; i < last; i++) {
+                UniformAllocation allocation = uniformRing.Push(m_Objects[i]);
+                uniformRing.Bind(commandBuffer, m_Pipeline->GetLayout(), 0, allocation);
+                RenderCommand::DrawIndexed(6);
+            }
+        });
+    }
+}
+
+void PushConstantScene::Setup() {
+    m_VertexBuffer = CreateTintedQuadVertexBuffer();
+    m_IndexBuffer = CreateQuadIndexBuffer();
+    m_Objects = CreateSceneObjects(m_Count);
+
+    PushConstantRange pushConstantRange{};
+    pushConstantRange.Stages = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.Size = sizeof(SceneObject);
+
+    PipelineDescription pipelineDescription{};
+    pipelineDescription.Framebuffer = Renderer::GetFramebuffer();
+    pipelineDescription.Shaders = std::make_shared<Shader>((std::filesystem::path)"shaders/push_constant_vert.spv", (std::filesystem::path)"shaders/frag.spv");
+    pipelineDescription.VertexLayouts = {
+        {
+            { ShaderDataType::Float2, "a_Position" },
+            { ShaderDataType::Float3, "a_Color" }
+        }
+    };
+    pipelineDescription.PushConstantRanges = { pushConstantRange };
+    pipelineDescription.DynamicStates = { DynamicStates::Viewport, DynamicStates::Scissor };
+
+    m_Pipeline = Renderer::GetPipeline(pipelineDescription);
+}
+
+void PushConstantScene::Teardown() {
+    m_Pipeline.reset();
+    m_VertexBuffer.reset();
+    m_IndexBuffer.reset();
+    m_Objects.clear();
+}
+
+void PushConstantScene::OnFrame() {
+    //Split up so the draws can be spread across recording threads
+    const uint32_t drawsPerCommand = 256;
+
+    for (uint32_t first = 0; first < m_Count; first += drawsPerCommand) {
+        Renderer::Submit([this, first, drawsPerCommand](VkCommandBuffer commandBuffer) {
+            m_Pipeline->Bind(commandBuffer);
+            m_VertexBuffer->Bind(commandBuffer, 0);
+            m_IndexBuffer->Bind(commandBuffer);
+
+            const uint32_t last = (std::min)(first + drawsPerCommand, m_Count);
+            for (uint32_t i = first; i < last; i++) {
+                Renderer::PushConstants(*m_Pipeline, m_Objects[i]);
+                RenderCommand::DrawIndexed(6);
+            }
+        });
+    }
+}
+
+//Texture colors are 0xAABBGGRR, the byte order of RGBA8
+static const uint32_t CHECKER_BACKGROUND = 0xff202020;
+
+static uint32_t GetCheckerColor(uint32_t texture) {
+    return 0xff000000 | ((texture * 0x35) & 0xff) << 16 | ((texture * 0x9b) & 0xff) << 8 | 0xff;
+}
+
+static uint16_t PackRgb565(uint32_t color) {
+    const uint32_t r = color & 0xff, g = (color >> 8) & 0xff, b = (color >> 16) & 0xff;
+    return static_cast<uint16_t>((r >> 3) << 11 | (g >> 2) << 5 | (b >> 3));
+}
+
+static uint32_t AverageColors(uint32_t a, uint32_t b) {
+    uint32_t color = 0;
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+        color |= ((((a >> shift) & 0xff) + ((b >> shift) & 0xff)) / 2) << shift;
+    return color;
+}
+
+//The same checkerboard as the RGBA8 textures as a BC1 KTX2 file. A 4x4 block never holds more than the two checker
+//colors, so the base level is stored exactly. Levels whose texels are larger than a cell are the average of both.
+static void WriteCheckerboardKtx2(const std::filesystem::path& path, uint32_t size, uint32_t cellSize, uint32_t color) {
+    const TextureFormat format = TextureFormat::BC1_RGB;
+    const uint32_t levelCount = Texture::CalculateMipLevels(size, size);
+
+    std::vector<std::vector<uint8_t>> levels(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const uint32_t blocks = ((std::max)(size >> level, 1u) + 3) / 4;
+        const bool resolved = (cellSize >> level) > 0;
+
+        //Index 0 picks the first endpoint, 1 the second, which means the same in BC1's 3 and 4 color modes
+        const uint16_t endpoints[2] = {
+            PackRgb565(resolved ? color : AverageColors(color, CHECKER_BACKGROUND)),
+            PackRgb565(resolved ? CHECKER_BACKGROUND : AverageColors(color, CHECKER_BACKGROUND))
+        };
+
+        levels[level].resize(Texture::CalculateLevelSize(format, size, size, level));
+        for (uint32_t blockY = 0; blockY < blocks; blockY++) {
+            for (uint32_t blockX = 0; blockX < blocks; blockX++) {
+                uint32_t indices = 0;
+                for (uint32_t texel = 0; texel < 16 && resolved; texel++) {
+                    const uint32_t x = (blockX * 4 + texel % 4) << level;
+                    const uint32_t y = (blockY * 4 + texel / 4) << level;
+                    if ((x / cellSize + y / cellSize) % 2 == 0)
+                        indices |= 1u << (texel * 2);
+                }
+
+                uint8_t* block = &levels[level][(blockY * blocks + blockX) * 8];
+                memcpy(block, endpoints, sizeof(endpoints));
+                memcpy(block + 4, &indices, sizeof(indices));
+            }
+        }
+    }
+
+    //Data format descriptor with a single BC1 RGB sample, the loader doesn't read it but the format requires one
+    const uint32_t dfd[] = {
+        44,
+        0, 2 | 40 << 16, 128 | 1 << 8 | 1 << 16, 3 | 3 << 8, 8, 0,
+        63 << 16, 0, 0, 0xffffffff
+    };
+
+    //Header, level index and descriptor, then the levels from the smallest up, the layout the KTX 2.0 specification asks for
+    const uint32_t dfdOffset = 80 + levelCount * 24;
+    const uint64_t dataOffset = (dfdOffset + sizeof(dfd) + 7) & ~7ull;
+
+    std::vector<uint64_t> levelIndex(levelCount * 3);
+    uint64_t offset = dataOffset;
+    for (uint32_t level = levelCount; level-- > 0;) {
+        levelIndex[level * 3] = offset;
+        levelIndex[level * 3 + 1] = levels[level].size();
+        levelIndex[level * 3 + 2] = levels[level].size();
+        offset += levels[level].size();
+    }
+
+    const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const uint32_t header[] = {
+        static_cast<uint32_t>(GetVkTextureFormat(format)), 1, size, size, 0, 0, 1, levelCount, 0,
+        dfdOffset, static_cast<uint32_t>(sizeof(dfd)), 0, 0
+    };
+    const uint64_t supercompressionData[] = { 0, 0 };
+    const uint8_t padding[8] = {};
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to write " + path.string() + "!");
+    }
+
+    file.write(reinterpret_cast<const char*>(identifier), sizeof(identifier));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(supercompressionData), sizeof(supercompressionData));
+    file.write(reinterpret_cast<const char*>(levelIndex.data()), levelIndex.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(dfd), sizeof(dfd));
+    file.write(reinterpret_cast<const char*>(padding), dataOffset - dfdOffset - sizeof(dfd));
+    for (uint32_t level = levelCount; level-- > 0;)
+        file.write(reinterpret_cast<const char*>(levels[level].data()), levels[level].size());
+
+    if (!file) {
+        throw std::runtime_error("failed to write " + path.string() + "!");
+    }
+}
+
+const char* TextureScene::GetName() const {
+    switch (m_Mode) {
+        case TextureSceneMode::Mipmapped:		return "textures";
+        case TextureSceneMode::NoMips:			return "textures_no_mips";
+        case TextureSceneMode::CompressedKtx2:	return "textures_ktx2";
+    }
+
+    return "textures";
+}
+
+void TextureScene::Setup() {
+    m_VertexBuffer = CreateTintedQuadVertexBuffer();
+    m_IndexBuffer = CreateQuadIndexBuffer();
+    m_Objects = CreateSceneObjects(m_Count);
+
+    DescriptorBinding binding{};
+    binding.Binding = 0;
+    binding.Type = DescriptorType::CombinedImageSampler;
+    binding.Stages = VK_SHADER_STAGE_FRAGMENT_BIT;
+    m_TextureLayout = std::make_shared<DescriptorSetLayout>(std::vector<DescriptorBinding>{ binding });
+
+    //Checkerboards of different cell sizes, fine enough to alias badly when sampled without mipmaps
+    std::vector<uint32_t> pixels;
+    for (uint32_t i = 0; i < TEXTURE_COUNT; i++) {
+        const uint32_t cellSize = 1 + i % 4;
+        const uint32_t color = GetCheckerColor(i);
+
+        std::unique_ptr<Texture> texture;
+        if (m_Mode == TextureSceneMode::CompressedKtx2) {
+            //Goes through the file so the memory mapped upload path is what gets measured. The mapping is closed once
+            //the texture is loaded, the file isn't needed after that.
+            std::filesystem::path path = std::filesystem::temp_directory_path() / ("benchmark_texture_" + std::to_string(i) + ".ktx2");
+            WriteCheckerboardKtx2(path, TEXTURE_SIZE, cellSize, color);
+
+            try {
+                texture = TextureLoader::LoadKtx2(path);
+            }
+            catch (...) {
+                std::filesystem::remove(path);
+                throw;
+            }
+            std::filesystem::remove(path);
+        }
+        else {
+            pixels.resize(TEXTURE_SIZE * TEXTURE_SIZE);
+            for (uint32_t y = 0; y < TEXTURE_SIZE; y++) {
+                for (uint32_t x = 0; x < TEXTURE_SIZE; x++)
+                    pixels[y * TEXTURE_SIZE + x] = ((x / cellSize + y / cellSize) % 2) ? color : CHECKER_BACKGROUND;
+            }
+
+            TextureDescription textureDescription{};
+            textureDescription.Width = TEXTURE_SIZE;
+            textureDescription.Height = TEXTURE_SIZE;
+            textureDescription.GenerateMips = m_Mode == TextureSceneMode::Mipmapped;
+
+            texture = std::make_unique<Texture>(textureDescription);
+            texture->SetData(pixels.data(), pixels.size() * sizeof(uint32_t));
+        }
+
+        auto textureSet = std::make_unique<DescriptorSet>(m_TextureLayout);
+        textureSet->WriteImage(0, texture->GetImageView(), texture->GetSampler());
+
+        m_Textures.push_back(std::move(texture));
+        m_TextureSets.push_back(std::move(textureSet));
+    }
+
+    PushConstantRange pushConstantRange{};
+    pushConstantRange.Stages = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.Size = sizeof(SceneObject);
+
+    PipelineDescription pipelineDescription{};
+    pipelineDescription.Framebuffer = Renderer::GetFramebuffer();
+    pipelineDescription.Shaders = std::make_shared<Shader>((std::filesystem::path)"shaders/textured_vert.spv", (std::filesystem::path)"shaders/textured_frag.spv");
+    pipelineDescription.VertexLayouts = {
+        {
+            { ShaderDataType::Float2, "a_Position" },
+            { ShaderDataType::Float3, "a_Color" }
+        }
+    };
+    pipelineDescription.DescriptorSetLayouts = { m_TextureLayout };
+    pipelineDescription.PushConstantRanges = { pushConstantRange };
+    pipelineDescription.DynamicStates = { DynamicStates::Viewport, DynamicStates::Scissor };
+
+    m_Pipeline = Renderer::GetPipeline(pipelineDescription);
+}
+
+void TextureScene::Teardown() {
+    m_Pipeline.reset();
+    m_VertexBuffer.reset();
+    m_IndexBuffer.reset();
+    m_Objects.clear();
+
+    m_TextureSets.clear();
+    m_Textures.clear();
+    m_TextureLayout.reset();
+}
+
+void TextureScene::OnFrame() {
+    //Split up so the draws can be spread across recording threads
+    const uint32_t drawsPerCommand = 256;
+
+    for (uint32_t first = 0; first < m_Count; first += drawsPerCommand) {
+        Renderer::Submit([this, first, drawsPerCommand](VkCommandBuffer commandBuffer) {
+            m_Pipeline->Bind(commandBuffer);
+            m_VertexBuffer->Bind(commandBuffer, 0);
+            m_IndexBuffer->Bind(commandBuffer);
+
+            //Neighbouring objects share a texture, so the set only changes TEXTURE_COUNT times a frame
+            uint32_t boundTexture = TEXTURE_COUNT;
+
+            const uint32_t last = (std::min)(first + drawsPerCommand, m_Count);
+            for (uint32_t i = first; i < last; i++) {
+                uint32_t textureIndex = static_cast<uint32_t>(static_cast<uint64_t>(i) * TEXTURE_COUNT / m_Count);
+                if (textureIndex != boundTexture) {
+                    m_TextureSets[textureIndex]->Bind(commandBuffer, m_Pipeline->GetLayout(), 0);
+                    boundTexture = textureIndex;
+                }
+
+                Renderer::PushConstants(*m_Pipeline, m_Objects[i]);
+                RenderCommand::DrawIndexed(6);
+            }
+        });
+    }
+}
+
+void PipelineScene::Setup() {
+    const uint32_t gridSize = GetGridSize(m_Count);
+    const float size = 2.0f / gridSize * 0.9f;
+
+    //One quad per draw, picked with the draw's vertex offset
+    std::vector<QuadVertex> vertices;
+    vertices.reserve(m_Count * 4);
+    for (uint32_t i = 0; i < m_Count; i++) {
+        glm::vec2 position = GetGridPosition(i, gridSize);
+        glm::vec3 color = { (float)(i % gridSize) / gridSize, (float)(i / gridSize) / gridSize, 0.5f };
+
+        vertices.push_back({ { position.x, position.y }, color });
+        vertices.push_back({ { position.x + size, position.y }, color });
+        vertices.push_back({ { position.x + size, position.y + size }, color });
+        vertices.push_back({ { position.x, position.y + size }, color });
+    }
+
+    BufferDescription vertexBufferDescription{};
+    vertexBufferDescription.Type = BufferType::VertexBuffer;
+    vertexBufferDescription.MemoryType = BufferMemoryType::DeviceLocal;
+    vertexBufferDescription.Size = vertices.size() * sizeof(QuadVertex);
+
+    m_VertexBuffer = std::make_shared<Buffer>(vertexBufferDescription);
+    m_VertexBuffer->SetData(vertices.data(), vertexBufferDescription.Size);
+
+    m_IndexBuffer = CreateQuadIndexBuffer();
+
+    //Every combination of state the quads still render with, wireframe only where the device allows it
+    PipelineDescription pipelineDescription{};
+    pipelineDescription.Framebuffer = Renderer::GetFramebuffer();
+    pipelineDescription.Shaders = std::make_shared<Shader>((std::filesystem::path)"shaders/vert.spv", (std::filesystem::path)"shaders/frag.spv");
+    pipelineDescription.VertexLayouts = {
+        {
+            { ShaderDataType::Float2, "a_Position" },
+            { ShaderDataType::Float3, "a_Color" }
+        }
+    };
+    pipelineDescription.DynamicStates = { DynamicStates::Viewport, DynamicStates::Scissor };
+
+    const bool wireframeSupported = Device::Get().GetEnabledFeatures().fillModeNonSolid;
+    for (bool wireframe : { false, true }) {
+        if (wireframe && !wireframeSupported)
+            continue;
+
+        for (PrimitiveTopology topology : { PrimitiveTopology::TriangleList, PrimitiveTopology::TriangleStrip }) {
+            for (CullMode cull : { CullMode::None, CullMode::Back }) {
+                for (BlendMode blend : { BlendMode::None, BlendMode::Alpha, BlendMode::Additive }) {
+                    if (m_Pipelines.size() == m_Count)
+                        return;
+
+                    pipelineDescription.Wireframe = wireframe;
+                    pipelineDescription.Topology = topology;
+                    pipelineDescription.Cull = cull;
+                    pipelineDescription.Blend = blend;
+
+                    m_Pipelines.push_back(Renderer::GetPipeline(pipelineDescription));
+                }
+            }
+        }
+    }
+}
+
+void PipelineScene::Teardown() {
+    m_Pipelines.clear();
+    m_VertexBuffer.reset();
+    m_IndexBuffer.reset();
+}
+
+void PipelineScene::OnFrame() {
+    //One command per variant cycle so the draws can be split across recording threads
+    const uint32_t variantCount = static_cast<uint32_t>(m_Pipelines.size());
+
+    for (uint32_t first = 0; first < m_Count; first += variantCount) {
+        Renderer::Submit([this, first, variantCount](VkCommandBuffer commandBuffer) {
+            m_VertexBuffer->Bind(commandBuffer, 0);
+            m_IndexBuffer->Bind(commandBuffer);
+
+            const uint32_t last = (std::min)(first + variantCount, m_Count);
+            for (uint32_t i = first; i < last; i++) {
+                m_Pipelines[i % variantCount]->Bind(commandBuffer);
+                RenderCommand::DrawIndexed(6, 0, static_cast<int32_t>(i * 4));
+            }
+        });
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "BenchmarkScene.h"
+
+#include "Vulkan/VkBuffer.h"
+#include "Vulkan/VkPipeline.h"
+#include "Vulkan/VkTexture.h"
+#include "Vulkan/VkDescriptorSet.h"
+
+//Per draw data of the uniform and push constant scenes, std140 and matching the shaders' Object block
+struct SceneObject {
+	glm::mat4 Model;
+	glm::vec4 Color;
+};
+
+//count quads through Renderer::DrawQuad, batched MaxQuads at a time
+class QuadScene : public BenchmarkScene {
+public:
+	using BenchmarkScene::BenchmarkScene;
+
+	const char* GetName() const override { return "quads"; }
+
+	void Setup() override;
+	void OnFrame() override;
+
+	uint32_t GetDrawCallsPerFrame() const override;
+private:
+	std::vector<glm::vec2> m_Positions;
+	std::vector<glm::vec3> m_Colors;
+	glm::vec2 m_Size;
+};
+
+//count instances of one quad mesh in a single instanced draw, needs shaders/instanced_vert.spv
+class InstancedScene : public BenchmarkScene {
+public:
+	using BenchmarkScene::BenchmarkScene;
+
+	const char* GetName() const override { return "instanced"; }
+
+	void Setup() override;
+	void Teardown() override;
+	void OnFrame() override;
+
+	uint32_t GetDrawCallsPerFrame() const override { return 1; }
+private:
+	std::shared_ptr<Pipeline> m_Pipeline;
+	std::shared_ptr<Buffer> m_VertexBuffer;
+	std::shared_ptr<Buffer> m_IndexBuffer;
+	std::shared_ptr<Buffer> m_InstanceBuffer;
+};
+
+//count draws a frame, each with its own model matrix and color out of the renderer's uniform ring,
+//needs shaders/uniform_vert.spv
+class UniformScene : public BenchmarkScene {
+public:
+	using BenchmarkScene::BenchmarkScene;
+
+	const char* GetName() const override { return "uniforms"; }
+
+	void Setup() override;
+	void Teardown() override;
+	void OnFrame() override;
+
+	uint32_t GetDrawCallsPerFrame() const override { return m_Count; }
+private:
+	std::shared_ptr<Pipeline> m_Pipeline;
+	std::shared_ptr<Buffer> m_VertexBuffer;
+	std::shared_ptr<Buffer> m_IndexBuffer;
+	std::vector<SceneObject> m_Objects;
+};
+
+//The uniform scene with the per draw data in push constants instead, needs shaders/push_constant_vert.spv
+class PushConstantScene : public BenchmarkScene {
+public:
+	using BenchmarkScene::BenchmarkScene;
+
+	const char* GetName() const override { return "push_constants"; }
+
+	void Setup() override;
+	void Teardown() override;
+	void OnFrame() override;
+
+	uint32_t GetDrawCallsPerFrame() const override { return m_Count; }
+private:
+	std::shared_ptr<Pipeline> m_Pipeline;
+	std::shared_ptr<Buffer> m_VertexBuffer;
+	std::shared_ptr<Buffer> m_IndexBuffer;
+	std::vector<SceneObject> m_Objects;
+};
+
+enum class TextureSceneMode {
+	Mipmapped,		//RGBA8, mipmaps blitted on the GPU
+	NoMips,			//RGBA8 without mipmaps
+	CompressedKtx2	//BC1 with every level precomputed, written to KTX2 files and loaded through TextureLoader
+};
+
+//The push constant scene sampling one of TEXTURE_COUNT large textures per draw on quads much smaller than the
+//textures, with or without mipmaps to compare the bandwidth minification costs. Needs shaders/textured_*.spv
+class TextureScene : public BenchmarkScene {
+public:
+	TextureScene(uint32_t count, TextureSceneMode mode)
+		: BenchmarkScene(count), m_Mode(mode) {}
+
+	const char* GetName() const override;
+
+	void Setup() override;
+	void Teardown() override;
+	void OnFrame() override;
+
+	uint32_t GetDrawCallsPerFrame() const override { return m_Count; }
+public:
+	static const uint32_t TEXTURE_COUNT = 16;
+	static const uint32_t TEXTURE_SIZE = 1024;
+private:
+	TextureSceneMode m_Mode;
+
+	std::shared_ptr<Pipeline> m_Pipeline;
+	std::shared_ptr<Buffer> m_VertexBuffer;
+	std::shared_ptr<Buffer> m_IndexBuffer;
+	std::vector<SceneObject> m_Objects;
+
+	std::shared_ptr<DescriptorSetLayout> m_TextureLayout;
+	std::vector<std::unique_ptr<Texture>> m_Textures;
+	std::vector<std::unique_ptr<DescriptorSet>> m_TextureSets;
+};
+
+//count draws a frame, each binding the next of a set of distinct pipelines, measures state change cost
+class PipelineScene : public BenchmarkScene {
+public:
+	using BenchmarkScene::BenchmarkScene;
+
+	const char* GetName() const override { return "pipelines"; }
+
+	void Setup() override;
+	void Teardown() override;
+	void OnFrame() override;
+
+	uint32_t GetDrawCallsPerFrame() const override { return m_Count; }
+	uint32_t GetVariantCount() const { return static_cast<uint32_t>(m_Pipelines.size()); }
+private:
+	std::vector<std::shared_ptr<Pipeline>> m_Pipelines;
+	std::shared_ptr<Buffer> m_VertexBuffer;
+	std::shared_ptr<Buffer> m_IndexBuffer;
+};
+
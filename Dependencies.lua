@@ -7,6 +7,8 @@ IncludeDir["GLFW"] = "%{wks.location}/VulkanTest/vendor/GLFW/include"
 IncludeDir["glm"] = "%{wks.location}/VulkanTest/vendor/glm"
 IncludeDir["VulkanSDK"] = "%{VULKAN_SDK}/Include"
 
+ShaderCompiler = "%{VULKAN_SDK}/Bin/glslc"
+
 LibraryDir = {}
 
 LibraryDir["VulkanSDK"] = "%{VULKAN_SDK}/Lib"
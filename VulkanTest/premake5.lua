@@ -12,6 +12,8 @@ project "VulkanTest"
 		"src/**.cpp",
 		"vendor/glm/glm/**.hpp",
 		"vendor/glm/glm/**.inl",
+		"shaders/*.vert",
+		"shaders/*.frag"
 	}
 
 	defines {
@@ -32,6 +34,18 @@ project "VulkanTest"
 		"%{Library.Vulkan}"
 	}
 
+	--GLSL sources are compiled next to themselves as <name>_<stage>.spv, which is where the renderer loads them from.
+	--shader.vert and shader.frag predate this and are checked in as vert.spv and frag.spv.
+	filter { "files:**/shaders/*.vert", "files:not **/shaders/shader.*" }
+		buildmessage "Compiling %{file.name}"
+		buildcommands { '"%{ShaderCompiler}" "%{file.relpath}" -o "%{file.directory}/%{file.basename}_vert.spv"' }
+		buildoutputs { "%{file.directory}/%{file.basename}_vert.spv" }
+
+	filter { "files:**/shaders/*.frag", "files:not **/shaders/shader.*" }
+		buildmessage "Compiling %{file.name}"
+		buildcommands { '"%{ShaderCompiler}" "%{file.relpath}" -o "%{file.directory}/%{file.basename}_frag.spv"' }
+		buildoutputs { "%{file.directory}/%{file.basename}_frag.spv" }
+
 	filter "system:windows"
 		systemversion "latest"
 
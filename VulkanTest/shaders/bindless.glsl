@@ -0,0 +1,19 @@
+//Declarations matching BindlessHeap, included by shaders indexing resources by handle.
+//Define BINDLESS_SET before including when the heap isn't bound at set 1.
+#extension GL_EXT_nonuniform_qualifier : require
+
+#ifndef BINDLESS_SET
+#define BINDLESS_SET 1
+#endif
+
+layout(set = BINDLESS_SET, binding = 0) uniform texture2D u_Textures[];
+layout(set = BINDLESS_SET, binding = 1) uniform sampler u_Samplers[];
+
+layout(set = BINDLESS_SET, binding = 2, std430) readonly buffer BindlessBuffer {
+    uint data[];
+} u_Buffers[];
+
+//Handles that differ within a draw, e.g. per instance, have to be wrapped in nonuniformEXT
+vec4 SampleBindless(uint textureHandle, uint samplerHandle, vec2 uv) {
+    return texture(sampler2D(u_Textures[nonuniformEXT(textureHandle)], u_Samplers[nonuniformEXT(samplerHandle)]), uv);
+}
@@ -0,0 +1,14 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+//Per instance, one location per column
+layout(location = 2) in mat4 inModel;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = inModel * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor;
+}
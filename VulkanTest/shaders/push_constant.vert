@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+//Per draw, pushed right before the draw
+layout(push_constant) uniform Object {
+    mat4 model;
+    vec4 color;
+} object;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = object.model * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor * object.color.rgb;
+}
@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(set = 0, binding = 0) uniform sampler2D u_Texture;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = texture(u_Texture, fragTexCoord) * vec4(fragColor, 1.0);
+}
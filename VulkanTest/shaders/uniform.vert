@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+//Per draw, out of the renderer's uniform ring with a dynamic offset
+layout(set = 0, binding = 0) uniform Object {
+    mat4 model;
+    vec4 color;
+} object;
+
+layout(location = 0) out vec3 fragColor;
+
+void main() {
+    gl_Position = object.model * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor * object.color.rgb;
+}
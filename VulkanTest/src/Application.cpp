@@ -1,27 +1,96 @@
 #include "Application.h"
 
 #include "Renderer/RenderCommand.h"
+#include "Core/Instrumentor.h"
+#include "Core/JobSystem.h"
+
+#include <fstream>
+#include <iostream>
 
 Application* Application::m_Instance = nullptr;
 
-Application::Application() 
-    : m_Window(800, 600, "Vulkan Test"){
+Application::Application(const ApplicationSpecification& specification)
+    : m_Specification(specification), m_Window(specification.Width, specification.Height, specification.Name, specification.Headless) {
     m_Instance = this;
 
+    JobSystem::Get().Init(m_Specification.JobThreads);
     Renderer::Init();
+    Renderer::SetFramesInFlight(m_Specification.FramesInFlight);
+    Renderer::SetFramePacing(m_Specification.LowLatency ? FramePacing::LowLatency : FramePacing::Throughput);
+    Renderer::SetRecordingThreads(m_Specification.RecordingThreads);
+    Renderer::GetGpuProfiler().SetReportInterval(m_Specification.GpuProfileInterval, m_Specification.GpuProfilePath);
+
     RenderCommand::Init();
     RenderCommand::SetClearColor({ 0.0f, 0.0f, 0.0f, 1.0f });
+
+    if (m_Specification.Headless && !m_Specification.OutputPath.empty()) {
+        //Every frame overwrites the file, so what's left at the end is the last frame
+        Renderer::SetReadbackCallback([path = m_Specification.OutputPath](const ReadbackImage& image) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "failed to write " << path << std::endl;
+                return;
+            }
+
+            file << "P6\n" << image.Width << " " << image.Height << "\n255\n";
+            for (uint32_t y = 0; y < image.Height; y++) {
+                const uint8_t* row = image.Data + y * image.RowPitch;
+                for (uint32_t x = 0; x < image.Width; x++)
+                    file.write(reinterpret_cast<const char*>(row + x * 4), 3);
+            }
+        });
+    }
 }
 
 Application::~Application() {
     Renderer::Shutdown();
+    JobSystem::Get().Shutdown();
 }
 
 void Application::MainLoop() {
-    while (!m_Window.ShouldClose()) {
-        m_Window.OnUpdate();
+    uint32_t frameCount = m_Specification.FrameCount;
+    if (m_Specification.Headless && frameCount == 0)
+        frameCount = 1;
+
+    for (uint32_t frame = 0; frameCount == 0 || frame < frameCount; frame++) {
+        if (m_Window.ShouldClose())
+            break;
+
+        PROFILE_SCOPE("Frame");
+
+        {
+            PROFILE_SCOPE("PaceFrame");
+            Renderer::PaceFrame();
+        }
+
+        {
+            PROFILE_SCOPE("OnUpdate");
+            m_Window.OnUpdate();
+        }
+
+        {
+            PROFILE_SCOPE("Scene");
+
+            //A grid of quads shaded across the screen, drawn in a single batch
+            const int gridSize = 16;
+            const float cellSize = 2.0f / gridSize;
+
+            Renderer::BeginScene();
+            for (int y = 0; y < gridSize; y++) {
+                for (int x = 0; x < gridSize; x++) {
+                    glm::vec2 position = { -1.0f + x * cellSize, -1.0f + y * cellSize };
+                    glm::vec3 color = { (float)x / gridSize, (float)y / gridSize, 1.0f - (float)x / gridSize };
+                    Renderer::DrawQuad(position, glm::vec2(cellSize * 0.9f), color);
+                }
+            }
+            Renderer::EndScene();
+        }
+
         Renderer::DrawFrame();
 
-        m_Window.OnRender();
+        {
+            PROFILE_SCOPE("OnRender");
+            m_Window.OnRender();
+        }
     }
 }
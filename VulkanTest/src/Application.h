@@ -1,21 +1,61 @@
 #pragma once
 #include "Windows/Window.h"
+#include "Vulkan/VkFrameBuffer.h"
 
 #include <stdint.h>
+#include <string>
+
+struct ApplicationSpecification {
+    const char* Name = "Vulkan Test";
+    uint32_t Width = 800;
+    uint32_t Height = 600;
+
+    //Renders offscreen without a window or surface, the loop ends after FrameCount frames
+    bool Headless = false;
+
+    //0 keeps running until the window is closed, headless always renders at least one frame
+    uint32_t FrameCount = 0;
+
+    //Headless only, the last rendered frame is written here as a binary PPM
+    std::string OutputPath;
+
+    //1 to Device::MAX_FRAMES_IN_FLIGHT, fewer means less latency but less CPU/GPU overlap
+    uint32_t FramesInFlight = 2;
+    bool LowLatency = false;
+
+    //Mailbox or Immediate to run uncapped, 0 swapchain images lets the surface decide
+    PresentMode PreferredPresentMode = PresentMode::Fifo;
+    uint32_t SwapChainImageCount = 0;
+
+    //GPU timings are reported every GpuProfileInterval frames, to stdout or to GpuProfilePath as CSV
+    uint32_t GpuProfileInterval = 0;
+    std::string GpuProfilePath;
+
+    //Workers of the job system, 0 uses every hardware thread but the main one
+    uint32_t JobThreads = 0;
+
+    //Threads recording draws into secondary command buffers, 1 records inline and 0 uses every job system thread
+    uint32_t RecordingThreads = 1;
+
+    //CPU timings of the whole run are written here as a Chrome trace, open it in Perfetto or chrome://tracing
+    std::string TracePath;
+};
 
 class Application {
 public:
-    Application();
+    Application(const ApplicationSpecification& specification = ApplicationSpecification());
     ~Application();
 
     void MainLoop();
 
     Window& GetWindow() { return m_Window; }
+    const ApplicationSpecification& GetSpecification() const { return m_Specification; }
 
     static Application& Get() { return *m_Instance; }
 private:
     static Application* m_Instance;
 
+    ApplicationSpecification m_Specification;
     Window m_Window;
     const uint32_t WIDTH = 800;
     const uint32_t HEIGHT = 600;
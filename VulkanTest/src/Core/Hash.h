@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+//64 bit FNV-1a, fast enough for hashing pipeline state and shader code at load time
+static const uint64_t HASH_SEED = 14695981039346656037ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = HASH_SEED) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+template<typename T>
+inline uint64_t HashValue(const T& value, uint64_t hash = HASH_SEED) {
+	return HashBytes(&value, sizeof(T), hash);
+}
@@ -0,0 +1,149 @@
+#include "Instrumentor.h"
+
+#include <iostream>
+
+Instrumentor Instrumentor::s_Instance;
+
+void Instrumentor::BeginSession(const std::string& name, const std::filesystem::path& filepath) {
+    if (IsActive()) {
+        std::cerr << "instrumentor: " << name << " started while another session is running, ending that one first" << std::endl;
+        EndSession();
+    }
+
+    m_OutputStream.open(filepath, std::ios::trunc);
+    if (!m_OutputStream.is_open()) {
+        std::cerr << "instrumentor: failed to open " << filepath << std::endl;
+        return;
+    }
+
+    //Whatever is left in the rings from an earlier session is stale
+    {
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        for (auto& buffer : m_Buffers)
+            buffer->Tail.store(buffer->Head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    m_SessionStart = Clock::now();
+    m_FirstEvent = true;
+    WriteHeader();
+
+    m_StopFlushing = false;
+    m_FlushThread = std::thread(&Instrumentor::FlushLoop, this);
+
+    m_Active.store(true, std::memory_order_release);
+}
+
+void Instrumentor::EndSession() {
+    if (!IsActive())
+        return;
+
+    m_Active.store(false, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(m_FlushMutex);
+        m_StopFlushing = true;
+    }
+    m_FlushWake.notify_one();
+    m_FlushThread.join();
+
+    //Scopes that were open when the session ended may still land here, take them along
+    Drain();
+    WriteFooter();
+    m_OutputStream.close();
+
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        for (auto& buffer : m_Buffers)
+            dropped += buffer->Dropped.exchange(0);
+    }
+
+    if (dropped > 0)
+        std::cerr << "instrumentor: dropped " << dropped << " events, the flush thread couldn't keep up" << std::endl;
+}
+
+void Instrumentor::WriteEvent(const char* name, int64_t start, int64_t duration) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+    if (head - buffer.Tail.load(std::memory_order_acquire) >= RING_CAPACITY) {
+        buffer.Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.Events[head % RING_CAPACITY] = { name, start, duration };
+    buffer.Head.store(head + 1, std::memory_order_release);
+}
+
+Instrumentor::ThreadBuffer& Instrumentor::GetThreadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        buffer->ThreadID = static_cast<uint32_t>(m_Buffers.size());
+        m_Buffers.push_back(buffer);
+    }
+
+    return *buffer;
+}
+
+void Instrumentor::FlushLoop() {
+    std::unique_lock<std::mutex> lock(m_FlushMutex);
+
+    while (!m_StopFlushing) {
+        m_FlushWake.wait_for(lock, std::chrono::milliseconds(10));
+
+        lock.unlock();
+        Drain();
+        lock.lock();
+    }
+}
+
+void Instrumentor::Drain() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        buffers = m_Buffers;
+    }
+
+    for (auto& buffer : buffers) {
+        uint64_t tail = buffer->Tail.load(std::memory_order_relaxed);
+        uint64_t head = buffer->Head.load(std::memory_order_acquire);
+
+        for (; tail < head; tail++) {
+            const ProfileEvent& event = buffer->Events[tail % RING_CAPACITY];
+
+            if (!m_FirstEvent)
+                m_OutputStream << ",";
+            m_FirstEvent = false;
+
+            m_OutputStream << "\n{\"cat\":\"function\",\"name\":\"";
+            for (const char* c = event.Name; *c; c++) {
+                if (*c == '"' || *c == '\\')
+                    m_OutputStream << '\\';
+                m_OutputStream << *c;
+            }
+
+            //Chrome trace timestamps are in microseconds
+            m_OutputStream << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->ThreadID
+                << ",\"ts\":" << event.Start / 1000 << "." << event.Start % 1000 / 100
+                << ",\"dur\":" << event.Duration / 1000 << "." << event.Duration % 1000 / 100 << "}";
+        }
+
+        buffer->Tail.store(tail, std::memory_order_release);
+    }
+
+    m_OutputStream.flush();
+}
+
+void Instrumentor::WriteHeader() {
+    m_OutputStream << "{\"otherData\":{},\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    m_OutputStream.flush();
+}
+
+void Instrumentor::WriteFooter() {
+    m_OutputStream << "\n]}\n";
+    m_OutputStream.flush();
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+
+//Set to 0 to compile every PROFILE_ macro away
+#ifndef ENABLE_PROFILING
+#define ENABLE_PROFILING 1
+#endif
+
+struct ProfileEvent {
+	const char* Name;		//Has to outlive the session, scopes only ever pass string literals
+	int64_t Start;			//Nanoseconds since the session began
+	int64_t Duration;
+};
+
+//Collects scoped CPU timings into per thread ring buffers, a background thread drains them into a Chrome trace
+//event file that chrome://tracing and Perfetto can open. Recording never takes a lock or touches the file, when a
+//ring is full the event is dropped and counted instead.
+class Instrumentor {
+public:
+	static Instrumentor& Get() { return s_Instance; }
+
+	void BeginSession(const std::string& name, const std::filesystem::path& filepath);
+	void EndSession();
+
+	bool IsActive() const { return m_Active.load(std::memory_order_acquire); }
+	int64_t GetTime() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_SessionStart).count(); }
+
+	void WriteEvent(const char* name, int64_t start, int64_t duration);
+public:
+	static const uint32_t RING_CAPACITY = 16384;
+private:
+	using Clock = std::chrono::steady_clock;
+
+	//Single producer, the owning thread, and single consumer, the flush thread
+	struct ThreadBuffer {
+		std::array<ProfileEvent, RING_CAPACITY> Events;
+		std::atomic<uint64_t> Head = 0;
+		std::atomic<uint64_t> Tail = 0;
+		std::atomic<uint64_t> Dropped = 0;
+		uint32_t ThreadID = 0;
+	};
+
+	ThreadBuffer& GetThreadBuffer();
+
+	void FlushLoop();
+	void Drain();
+	void WriteHeader();
+	void WriteFooter();
+private:
+	static Instrumentor s_Instance;
+
+	std::atomic<bool> m_Active = false;
+	Clock::time_point m_SessionStart;
+	std::ofstream m_OutputStream;
+	bool m_FirstEvent = true;
+
+	//Buffers stay registered after their thread exits so nothing it recorded is lost
+	std::mutex m_BuffersMutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_Buffers;
+
+	std::thread m_FlushThread;
+	std::mutex m_FlushMutex;
+	std::condition_variable m_FlushWake;
+	bool m_StopFlushing = false;
+};
+
+class InstrumentationTimer {
+public:
+	InstrumentationTimer(const char* name)
+		: m_Name(name), m_Start(Instrumentor::Get().IsActive() ? Instrumentor::Get().GetTime() : -1) {}
+
+	~InstrumentationTimer() {
+		if (m_Start >= 0)
+			Instrumentor::Get().WriteEvent(m_Name, m_Start, Instrumentor::Get().GetTime() - m_Start);
+	}
+private:
+	const char* m_Name;
+	int64_t m_Start;
+};
+
+#if ENABLE_PROFILING
+	#if defined(_MSC_VER)
+		#define PROFILE_FUNC_SIG __FUNCSIG__
+	#else
+		#define PROFILE_FUNC_SIG __PRETTY_FUNCTION__
+	#endif
+
+	#define PROFILE_BEGIN_SESSION(name, filepath) ::Instrumentor::Get().BeginSession(name, filepath)
+	#define PROFILE_END_SESSION() ::Instrumentor::Get().EndSession()
+	#define PROFILE_SCOPE_LINE2(name, line) ::InstrumentationTimer timer##line(name)
+	#define PROFILE_SCOPE_LINE(name, line) PROFILE_SCOPE_LINE2(name, line)
+	#define PROFILE_SCOPE(name) PROFILE_SCOPE_LINE(name, __LINE__)
+	#define PROFILE_FUNCTION() PROFILE_SCOPE(PROFILE_FUNC_SIG)
+#else
+	#define PROFILE_BEGIN_SESSION(name, filepath)
+	#define PROFILE_END_SESSION()
+	#define PROFILE_SCOPE(name)
+	#define PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,249 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+JobSystem JobSystem::s_Instance;
+
+void JobSystem::Init(uint32_t threadCount) {
+    if (!m_Threads.empty()) {
+        throw std::runtime_error("job system is already initialized!");
+    }
+
+    if (threadCount == 0)
+        threadCount = (std::max)(2u, std::thread::hardware_concurrency()) - 1;
+
+    m_Queues.clear();
+    for (uint32_t i = 0; i < threadCount + 1; i++)
+        m_Queues.push_back(std::make_unique<JobQueue>());
+
+    m_Stopping = false;
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+}
+
+void JobSystem::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Stopping = true;
+    }
+    m_JobAvailable.notify_all();
+
+    //Jobs that are still queued get finished before the workers exit
+    for (auto& thread : m_Threads)
+        thread.join();
+
+    //A job may have been pushed while the last worker was already on its way out
+    Job job;
+    while (TryPop(job))
+        Execute(job);
+
+    m_Threads.clear();
+    m_Queues.clear();
+}
+
+void JobSystem::Run(JobFunction&& job, JobCounter* counter) {
+    if (counter)
+        counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+    Job newJob{ std::move(job), counter };
+    if (RunsInline()) {
+        Execute(newJob);
+        return;
+    }
+
+    Push(std::move(newJob));
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, JobFunction&& job, JobCounter* counter) {
+    if (counter)
+        counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        //The last job of the dependency takes the same lock to release its continuations, so none can be missed
+        std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+        if (!dependency.IsDone()) {
+            dependency.m_Continuations.push_back({ std::move(job), counter });
+            return;
+        }
+    }
+
+    Job newJob{ std::move(job), counter };
+    if (RunsInline())
+        Execute(newJob);
+    else
+        Push(std::move(newJob));
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t minRangeSize, const std::function<void(uint32_t, uint32_t)>& function, JobCounter* counter) {
+    if (count == 0)
+        return;
+
+    //A few ranges per thread, so threads that finish early can steal what's left from the others
+    const uint32_t maxRanges = (GetThreadCount() + 1) * 4;
+    const uint32_t rangeCount = std::clamp(count / (std::max)(minRangeSize, 1u), 1u, maxRanges);
+
+    auto sharedFunction = std::make_shared<std::function<void(uint32_t, uint32_t)>>(function);
+    for (uint32_t range = 0; range < rangeCount; range++) {
+        const uint32_t begin = static_cast<uint32_t>(uint64_t(range) * count / rangeCount);
+        const uint32_t end = static_cast<uint32_t>(uint64_t(range + 1) * count / rangeCount);
+
+        Run([sharedFunction, begin, end]() { (*sharedFunction)(begin, end); }, counter);
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    JobQueue* ownQueue = m_Queues.empty() ? nullptr : m_Queues[s_QueueIndex].get();
+
+    while (!counter.IsDone()) {
+        Job job;
+        if (TryPop(job)) {
+            ownQueue->JobsHelped.fetch_add(1, std::memory_order_relaxed);
+            Execute(job);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    //The job that finished the counter may still hold its lock, the caller is free to destroy it once this returns
+    std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+JobSystemStats JobSystem::GetStats() const {
+    JobSystemStats stats{};
+
+    for (auto& queue : m_Queues) {
+        stats.JobsRun += queue->JobsRun.load(std::memory_order_relaxed);
+        stats.JobsStolen += queue->JobsStolen.load(std::memory_order_relaxed);
+        stats.JobsHelped += queue->JobsHelped.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+void JobSystem::ResetStats() {
+    for (auto& queue : m_Queues) {
+        queue->JobsRun.store(0, std::memory_order_relaxed);
+        queue->JobsStolen.store(0, std::memory_order_relaxed);
+        queue->JobsHelped.store(0, std::memory_order_relaxed);
+    }
+}
+
+void JobSystem::Push(Job&& job) {
+    //Counted before it is queued, a worker that sees the count but not the job yet just looks again
+    m_QueuedJobs.fetch_add(1);
+
+    JobQueue& queue = *m_Queues[s_QueueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        queue.Jobs.push_back(std::move(job));
+    }
+
+    if (m_SleepingThreads.load() > 0) {
+        //Taking the lock makes sure a worker that is about to sleep either sees the job or gets woken up
+        { std::lock_guard<std::mutex> lock(m_SleepMutex); }
+        m_JobAvailable.notify_one();
+    }
+}
+
+bool JobSystem::TryPop(Job& job) {
+    if (m_Queues.empty())
+        return false;
+
+    const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+    JobQueue& ownQueue = *m_Queues[s_QueueIndex];
+
+    //Newest job first from our own deque, its data is most likely still in cache
+    {
+        std::lock_guard<std::mutex> lock(ownQueue.Mutex);
+        if (!ownQueue.Jobs.empty()) {
+            job = std::move(ownQueue.Jobs.back());
+            ownQueue.Jobs.pop_back();
+            m_QueuedJobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    //Oldest job from someone else's, busy deques are skipped instead of waited on
+    for (uint32_t i = 1; i < queueCount; i++) {
+        JobQueue& queue = *m_Queues[(s_QueueIndex + i) % queueCount];
+
+        std::unique_lock<std::mutex> lock(queue.Mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.Jobs.empty())
+            continue;
+
+        job = std::move(queue.Jobs.front());
+        queue.Jobs.pop_front();
+        m_QueuedJobs.fetch_sub(1);
+        ownQueue.JobsStolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(Job& job) {
+    job.Function();
+
+    if (!m_Queues.empty())
+        m_Queues[s_QueueIndex]->JobsRun.fetch_add(1, std::memory_order_relaxed);
+
+    if (job.Counter)
+        Finish(job.Counter);
+}
+
+void JobSystem::Finish(JobCounter* counter) {
+    //Only the last job has to release continuations, the others just count down
+    uint32_t pending = counter->m_Pending.load(std::memory_order_relaxed);
+    while (pending > 1) {
+        if (counter->m_Pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+    }
+
+    //The counter only reaches 0 under its lock, so Wait can't return while it is still being used here
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_Mutex);
+        if (counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuations.swap(counter->m_Continuations);
+    }
+
+    for (auto& continuation : continuations) {
+        Job job{ std::move(continuation.Function), continuation.Counter };
+        if (RunsInline())
+            Execute(job);
+        else
+            Push(std::move(job));
+    }
+}
+
+void JobSystem::WorkerLoop(uint32_t queueIndex) {
+    s_QueueIndex = queueIndex;
+
+    while (true) {
+        Job job;
+        if (TryPop(job)) {
+            Execute(job);
+            continue;
+        }
+
+        //Frame work comes in bursts, spin for a moment before going to sleep
+        bool jobQueued = false;
+        for (uint32_t spin = 0; spin < SPIN_COUNT && !jobQueued; spin++) {
+            std::this_thread::yield();
+            jobQueued = m_QueuedJobs.load(std::memory_order_relaxed) > 0;
+        }
+
+        if (jobQueued)
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_SleepingThreads.fetch_add(1);
+        m_JobAvailable.wait(lock, [this]() { return m_Stopping || m_QueuedJobs.load() > 0; });
+        m_SleepingThreads.fetch_sub(1);
+
+        if (m_Stopping && m_QueuedJobs.load() == 0)
+            return;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using JobFunction = std::function<void()>;
+
+//Counts the jobs that still have to finish. Jobs that depend on a counter are held back until it reaches 0,
+//so don't add new jobs to a counter that something is already waiting on.
+class JobCounter {
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+	uint32_t GetPending() const { return m_Pending.load(std::memory_order_acquire); }
+private:
+	struct Continuation {
+		JobFunction Function;
+		JobCounter* Counter;
+	};
+
+	std::atomic<uint32_t> m_Pending = 0;
+
+	std::mutex m_Mutex;
+	std::vector<Continuation> m_Continuations;
+
+	friend class JobSystem;
+};
+
+struct JobSystemStats {
+	uint64_t JobsRun = 0;
+	uint64_t JobsStolen = 0;
+
+	//Jobs run by threads waiting on a counter instead of by workers
+	uint64_t JobsHelped = 0;
+};
+
+//Work stealing scheduler. Every worker owns a deque it pushes to and pops from at the back, idle workers steal the
+//oldest job from the front of someone else's. Threads that aren't workers, like the main thread, share one more
+//deque. Waiting on a counter runs queued jobs until the counter is done instead of blocking, so any thread can
+//wait without deadlocking, even when the jobs it waits on are still queued behind it.
+class JobSystem {
+public:
+	static JobSystem& Get() { return s_Instance; }
+
+	//0 picks one worker per hardware thread, leaving one for the main thread
+	void Init(uint32_t threadCount = 0);
+
+	//Finishes every queued job first. Jobs submitted once it has started run right away on the submitting thread.
+	void Shutdown();
+
+	//Without workers, before Init, with 0 workers or during Shutdown, jobs run right away on the calling thread. Jobs must not throw.
+	void Run(JobFunction&& job, JobCounter* counter = nullptr);
+
+	//Queues the job once dependency is done, without a thread blocking in the meantime
+	void RunAfter(JobCounter& dependency, JobFunction&& job, JobCounter* counter = nullptr);
+
+	//Splits [0, count) into ranges of at least minRangeSize and calls function(begin, end) for each of them
+	void ParallelFor(uint32_t count, uint32_t minRangeSize, const std::function<void(uint32_t, uint32_t)>& function, JobCounter* counter);
+
+	//Runs queued jobs on the calling thread until the counter is done
+	void Wait(JobCounter& counter);
+
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+	bool IsWorkerThread() const { return s_QueueIndex != 0; }
+
+	JobSystemStats GetStats() const;
+	void ResetStats();
+private:
+	struct Job {
+		JobFunction Function;
+		JobCounter* Counter;
+	};
+
+	//Padded so neighbouring queues never share a cache line, the stats are those of the threads owning the queue
+	struct alignas(64) JobQueue {
+		std::mutex Mutex;
+		std::deque<Job> Jobs;
+
+		std::atomic<uint64_t> JobsRun = 0;
+		std::atomic<uint64_t> JobsStolen = 0;
+		std::atomic<uint64_t> JobsHelped = 0;
+	};
+
+	bool RunsInline() const { return m_Threads.empty() || m_Stopping.load(std::memory_order_acquire); }
+
+	void Push(Job&& job);
+	bool TryPop(Job& job);
+	void Execute(Job& job);
+	void Finish(JobCounter* counter);
+
+	void WorkerLoop(uint32_t queueIndex);
+private:
+	static JobSystem s_Instance;
+
+	//0 for every thread that isn't a worker, worker i owns queue i + 1
+	inline static thread_local uint32_t s_QueueIndex = 0;
+
+	std::vector<std::unique_ptr<JobQueue>> m_Queues;
+	std::vector<std::thread> m_Threads;
+
+	std::atomic<uint32_t> m_QueuedJobs = 0;
+	std::atomic<uint32_t> m_SleepingThreads = 0;
+	std::mutex m_SleepMutex;
+	std::condition_variable m_JobAvailable;
+	std::atomic<bool> m_Stopping = false;
+
+	static const uint32_t SPIN_COUNT = 64;
+};
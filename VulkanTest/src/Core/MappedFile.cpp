@@ -0,0 +1,101 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    m_File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_File == INVALID_HANDLE_VALUE) {
+        m_File = nullptr;
+        throw std::runtime_error("failed to open " + path.string() + "!");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_File, &fileSize)) {
+        CloseHandle(m_File);
+        throw std::runtime_error("failed to get the size of " + path.string() + "!");
+    }
+    m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+    //Empty files can't be mapped
+    if (m_Size == 0)
+        return;
+
+    m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping == nullptr) {
+        CloseHandle(m_File);
+        throw std::runtime_error("failed to map " + path.string() + "!");
+    }
+
+    m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_Data == nullptr) {
+        CloseHandle(m_Mapping);
+        CloseHandle(m_File);
+        throw std::runtime_error("failed to map " + path.string() + "!");
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (m_Data != nullptr)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping != nullptr)
+        CloseHandle(m_Mapping);
+    if (m_File != nullptr)
+        CloseHandle(m_File);
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    m_File = open(path.c_str(), O_RDONLY);
+    if (m_File == -1) {
+        throw std::runtime_error("failed to open " + path.string() + "!");
+    }
+
+    struct stat fileStat;
+    if (fstat(m_File, &fileStat) != 0) {
+        close(m_File);
+        throw std::runtime_error("failed to get the size of " + path.string() + "!");
+    }
+    m_Size = static_cast<size_t>(fileStat.st_size);
+
+    //Empty files can't be mapped
+    if (m_Size == 0)
+        return;
+
+    void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+    if (data == MAP_FAILED) {
+        close(m_File);
+        throw std::runtime_error("failed to map " + path.string() + "!");
+    }
+
+    //Read front to back once, into the staging buffer
+    madvise(data, m_Size, MADV_SEQUENTIAL);
+    m_Data = static_cast<const uint8_t*>(data);
+}
+
+MappedFile::~MappedFile() {
+    if (m_Data != nullptr)
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+    if (m_File != -1)
+        close(m_File);
+}
+#endif
+
+const uint8_t* MappedFile::GetRange(uint64_t offset, uint64_t size) const {
+    if (offset > m_Size || size > m_Size - offset) {
+        throw std::runtime_error("file range out of bounds!");
+    }
+
+    return m_Data + offset;
+}
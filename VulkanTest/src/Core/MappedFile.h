@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+//Read only view of a whole file, mapped into the address space instead of read into a buffer. Pages are only
+//loaded from disk when touched, so data can be copied straight from the file to where it is needed.
+class MappedFile {
+public:
+	MappedFile(const std::filesystem::path& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Size; }
+
+	//Bounds checked pointer to size bytes at offset, throws when the range is past the end of the file
+	const uint8_t* GetRange(uint64_t offset, uint64_t size) const;
+private:
+	const uint8_t* m_Data = nullptr;
+	size_t m_Size = 0;
+
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#else
+	int m_File = -1;
+#endif
+};
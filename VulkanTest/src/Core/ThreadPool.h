@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+//Fixed set of worker threads that run submitted jobs in FIFO order
+class ThreadPool {
+public:
+	//0 picks one thread per hardware thread, leaving one for the main thread
+	ThreadPool(uint32_t threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(std::function<void()> job);
+
+	//Blocks until the queue is empty and no job is running
+	void WaitIdle();
+
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+private:
+	void WorkerLoop();
+private:
+	std::vector<std::thread> m_Threads;
+	std::deque<std::function<void()>> m_Jobs;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_JobAvailable;
+	std::condition_variable m_Idle;
+
+	uint32_t m_RunningJobs = 0;
+	bool m_Stopping = false;
+};
@@ -1,11 +1,75 @@
 #include "Application.h"
+#include "Core/Instrumentor.h"
 
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 
-int main() {    
-    Application App;
+static PresentMode ParsePresentMode(const char* name) {
+    if (strcmp(name, "immediate") == 0)
+        return PresentMode::Immediate;
+    if (strcmp(name, "mailbox") == 0)
+        return PresentMode::Mailbox;
+    if (strcmp(name, "fifo-relaxed") == 0)
+        return PresentMode::FifoRelaxed;
+    if (strcmp(name, "fifo") != 0)
+        std::cerr << "unknown present mode " << name << ", using fifo" << std::endl;
 
-    App.MainLoop();
+    return PresentMode::Fifo;
+}
+
+int main(int argc, char** argv) {
+    ApplicationSpecification specification;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0)
+            specification.Headless = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            specification.FrameCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+            specification.FramesInFlight = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--low-latency") == 0)
+            specification.LowLatency = true;
+        else if (strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc)
+            specification.PreferredPresentMode = ParsePresentMode(argv[++i]);
+        else if (strcmp(argv[i], "--swapchain-images") == 0 && i + 1 < argc)
+            specification.SwapChainImageCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--job-threads") == 0 && i + 1 < argc)
+            specification.JobThreads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--recording-threads") == 0 && i + 1 < argc)
+            specification.RecordingThreads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--gpu-profile") == 0 && i + 1 < argc)
+            specification.GpuProfileInterval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--gpu-profile-csv") == 0 && i + 1 < argc)
+            specification.GpuProfilePath = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            specification.TracePath = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            specification.OutputPath = argv[++i];
+        else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+            specification.Width = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc)
+            specification.Height = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else
+            std::cerr << "unknown argument " << argv[i] << std::endl;
+    }
+
+    if (specification.FramesInFlight < 1 || specification.FramesInFlight > Device::MAX_FRAMES_IN_FLIGHT) {
+        std::cerr << "usage: --frames-in-flight must be between 1 and " << Device::MAX_FRAMES_IN_FLIGHT << std::endl;
+        return 1;
+    }
+
+    //The session outlives the application so startup and shutdown end up in the trace as well
+    if (!specification.TracePath.empty())
+        PROFILE_BEGIN_SESSION("VulkanTest", specification.TracePath);
+
+    {
+        Application App(specification);
+
+        App.MainLoop();
+    }
+
+    PROFILE_END_SESSION();
 
     return 0;
 }
\ No newline at end of file
@@ -16,6 +16,22 @@ public:
 		s_RendererAPI->SetClearColor(color);
 	}
 
+	inline static void Draw(uint32_t vertexCount, uint32_t firstVertex = 0) {
+		s_RendererAPI->Draw(vertexCount, firstVertex);
+	}
+
+	inline static void DrawIndexed(uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0) {
+		s_RendererAPI->DrawIndexed(indexCount, firstIndex, vertexOffset);
+	}
+
+	inline static void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex = 0, uint32_t firstInstance = 0) {
+		s_RendererAPI->DrawInstanced(vertexCount, instanceCount, firstVertex, firstInstance);
+	}
+
+	inline static void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) {
+		s_RendererAPI->DrawIndexedInstanced(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	}
+
 	inline static RendererAPI* GetRendererAPI() { return s_RendererAPI.get(); }
 private:
 	inline static std::unique_ptr<RendererAPI> s_RendererAPI;
@@ -0,0 +1,207 @@
+#include "VkBindlessHeap.h"
+
+#include <algorithm>
+#include <string>
+
+#include "VkDevice.h"
+
+BindlessHandle BindlessHeap::HandleList::Allocate(const char* name) {
+    if (!Free.empty()) {
+        BindlessHandle handle = Free.back();
+        Free.pop_back();
+        return handle;
+    }
+
+    if (Next == Capacity) {
+        throw std::runtime_error(std::string("bindless heap is out of ") + name + "!");
+    }
+
+    return Next++;
+}
+
+void BindlessHeap::Init(uint32_t maxTextures, uint32_t maxSamplers, uint32_t maxBuffers) {
+    if (!Device::Get().IsBindlessSupported()) {
+        throw std::runtime_error("bindless descriptors are not supported by the device!");
+    }
+
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2(Device::Get().GetPhysicalDevice(), &properties);
+
+    //Update after bind sets have their own, usually much higher, limits
+    m_Textures = {};
+    m_Textures.Capacity = (std::min)({ maxTextures, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages, indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages });
+    m_Samplers = {};
+    m_Samplers.Capacity = (std::min)({ maxSamplers, indexingProperties.maxDescriptorSetUpdateAfterBindSamplers, indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+    m_Buffers = {};
+    m_Buffers.Capacity = (std::min)({ maxBuffers, indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers, indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+    const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    const VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    std::vector<DescriptorBinding> bindings = {
+        { TEXTURE_BINDING, DescriptorType::SampledImage, stages, m_Textures.Capacity, bindingFlags },
+        { SAMPLER_BINDING, DescriptorType::Sampler, stages, m_Samplers.Capacity, bindingFlags },
+        { BUFFER_BINDING, DescriptorType::StorageBuffer, stages, m_Buffers.Capacity, bindingFlags }
+    };
+    m_Layout = std::make_shared<DescriptorSetLayout>(bindings);
+
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_Textures.Capacity },
+        { VK_DESCRIPTOR_TYPE_SAMPLER, m_Samplers.Capacity },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_Buffers.Capacity }
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    if (vkCreateDescriptorPool(Device::Get().GetDevice(), &poolInfo, nullptr, &m_Pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetLayout setLayout = m_Layout->GetLayout();
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_Pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+
+    if (vkAllocateDescriptorSets(Device::Get().GetDevice(), &allocInfo, &m_Set) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+    }
+}
+
+void BindlessHeap::Shutdown() {
+    if (m_Pool != VK_NULL_HANDLE)
+        vkDestroyDescriptorPool(Device::Get().GetDevice(), m_Pool, nullptr);
+
+    m_Pool = VK_NULL_HANDLE;
+    m_Set = VK_NULL_HANDLE;
+    m_Layout.reset();
+}
+
+BindlessHandle BindlessHeap::AddTexture(VkImageView imageView, VkImageLayout imageLayout) {
+    BindlessHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        handle = m_Textures.Allocate("textures");
+    }
+
+    UpdateTexture(handle, imageView, imageLayout);
+    return handle;
+}
+
+BindlessHandle BindlessHeap::AddSampler(VkSampler sampler) {
+    BindlessHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        handle = m_Samplers.Allocate("samplers");
+    }
+
+    UpdateSampler(handle, sampler);
+    return handle;
+}
+
+BindlessHandle BindlessHeap::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    BindlessHandle handle;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        handle = m_Buffers.Allocate("buffers");
+    }
+
+    UpdateBuffer(handle, buffer, offset, range);
+    return handle;
+}
+
+void BindlessHeap::UpdateTexture(BindlessHandle handle, VkImageView imageView, VkImageLayout imageLayout) {
+    WriteImage(TEXTURE_BINDING, handle, imageView, VK_NULL_HANDLE, imageLayout);
+}
+
+void BindlessHeap::UpdateSampler(BindlessHandle handle, VkSampler sampler) {
+    WriteImage(SAMPLER_BINDING, handle, VK_NULL_HANDLE, sampler, VK_IMAGE_LAYOUT_UNDEFINED);
+}
+
+void BindlessHeap::UpdateBuffer(BindlessHandle handle, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_Set;
+    descriptorWrite.dstBinding = BUFFER_BINDING;
+    descriptorWrite.dstArrayElement = handle;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    vkUpdateDescriptorSets(Device::Get().GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void BindlessHeap::RemoveTexture(BindlessHandle handle) {
+    Remove(m_Textures, handle);
+}
+
+void BindlessHeap::RemoveSampler(BindlessHandle handle) {
+    Remove(m_Samplers, handle);
+}
+
+void BindlessHeap::RemoveBuffer(BindlessHandle handle) {
+    Remove(m_Buffers, handle);
+}
+
+void BindlessHeap::Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t setIndex) const {
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, setIndex, 1, &m_Set, 0, nullptr);
+}
+
+uint32_t BindlessHeap::GetTextureCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Textures.GetCount();
+}
+
+uint32_t BindlessHeap::GetBufferCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Buffers.GetCount();
+}
+
+void BindlessHeap::Remove(HandleList& list, BindlessHandle handle) {
+    if (handle == INVALID_BINDLESS_HANDLE)
+        return;
+
+    //The slot keeps its old descriptor, which frames in flight may still index, until it is reused
+    Device::Get().GetDeletionQueue().Push([this, &list, handle]() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        list.Free.push_back(handle);
+    });
+}
+
+void BindlessHeap::WriteImage(uint32_t binding, BindlessHandle handle, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = imageView;
+    imageInfo.sampler = sampler;
+    imageInfo.imageLayout = imageLayout;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_Set;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = handle;
+    descriptorWrite.descriptorType = binding == SAMPLER_BINDING ? VK_DESCRIPTOR_TYPE_SAMPLER : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    vkUpdateDescriptorSets(Device::Get().GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
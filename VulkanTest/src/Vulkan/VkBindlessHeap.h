@@ -0,0 +1,77 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "VkDescriptorSet.h"
+
+//Index into one of the heap's arrays, pushed to shaders instead of binding the resource
+using BindlessHandle = uint32_t;
+static const BindlessHandle INVALID_BINDLESS_HANDLE = ~0u;
+
+//One global descriptor set holding every texture, sampler and storage buffer in update after bind arrays. It is bound
+//once per command buffer and shaders index it by handle, so draws using different materials can stay in one batch.
+//Arrays are partially bound, slots without a resource must simply never be indexed.
+class BindlessHeap {
+public:
+	//Only when Device::IsBindlessSupported()
+	void Init(uint32_t maxTextures = DEFAULT_MAX_TEXTURES, uint32_t maxSamplers = DEFAULT_MAX_SAMPLERS, uint32_t maxBuffers = DEFAULT_MAX_BUFFERS);
+	void Shutdown();
+
+	//Handles stay valid until removed, any thread may add, update or remove while frames are recorded
+	BindlessHandle AddTexture(VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	BindlessHandle AddSampler(VkSampler sampler);
+	BindlessHandle AddBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+	//Points an existing handle at another resource, frames in flight must not index it anymore
+	void UpdateTexture(BindlessHandle handle, VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	void UpdateSampler(BindlessHandle handle, VkSampler sampler);
+	void UpdateBuffer(BindlessHandle handle, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+	//The handle is only handed out again once the frames in flight are done with it
+	void RemoveTexture(BindlessHandle handle);
+	void RemoveSampler(BindlessHandle handle);
+	void RemoveBuffer(BindlessHandle handle);
+
+	void Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t setIndex) const;
+
+	//Pipelines declare this at the set index they bind the heap to, see shaders/bindless.glsl
+	const std::shared_ptr<DescriptorSetLayout>& GetLayout() const { return m_Layout; }
+	bool IsInitialized() const { return m_Set != VK_NULL_HANDLE; }
+
+	uint32_t GetTextureCount() const;
+	uint32_t GetBufferCount() const;
+public:
+	static const uint32_t TEXTURE_BINDING = 0;
+	static const uint32_t SAMPLER_BINDING = 1;
+	static const uint32_t BUFFER_BINDING = 2;
+
+	static const uint32_t DEFAULT_MAX_TEXTURES = 16384;
+	static const uint32_t DEFAULT_MAX_SAMPLERS = 64;
+	static const uint32_t DEFAULT_MAX_BUFFERS = 16384;
+private:
+	struct HandleList {
+		uint32_t Capacity = 0;
+		uint32_t Next = 0;
+		std::vector<BindlessHandle> Free;
+
+		BindlessHandle Allocate(const char* name);
+		uint32_t GetCount() const { return Next - static_cast<uint32_t>(Free.size()); }
+	};
+
+	void Remove(HandleList& list, BindlessHandle handle);
+	void WriteImage(uint32_t binding, BindlessHandle handle, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout);
+private:
+	std::shared_ptr<DescriptorSetLayout> m_Layout;
+	VkDescriptorPool m_Pool = VK_NULL_HANDLE;
+	VkDescriptorSet m_Set = VK_NULL_HANDLE;
+
+	HandleList m_Textures;
+	HandleList m_Samplers;
+	HandleList m_Buffers;
+
+	//vkUpdateDescriptorSets on the same set has to be externally synchronized
+	mutable std::mutex m_Mutex;
+};
@@ -1,14 +1,20 @@
 #include "VkBuffer.h"
 #include "VkDevice.h"
 
+#include "Core/Instrumentor.h"
+
+#include <algorithm>
+
 Buffer::Buffer(BufferDescription description)
     : m_Description(description) {
+    PROFILE_FUNCTION();
+
     VkDevice device = Device::Get().GetDevice();
 
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = description.Size;
-    bufferInfo.usage = description.GetVkBufferUsageFlagBits();
+    bufferInfo.usage = m_Description.GetVkBufferUsageFlags();
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
     if (vkCreateBuffer(device, &bufferInfo, nullptr, &m_Buffer) != VK_SUCCESS) {
@@ -18,52 +24,105 @@ Buffer::Buffer(BufferDescription description)
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(device, m_Buffer, &memRequirements);
 
-    //Allocate and assgin memory to buffer
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    //Sub-allocate from one of the device's memory blocks and bind the buffer to that range
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    if (m_Description.MemoryType == BufferMemoryType::PersistentlyMapped)
+        m_Allocation = allocator.Allocate(memRequirements, m_Description.GetVkMemoryPropertyFlags(), MemoryResourceType::Linear, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    else
+        m_Allocation = allocator.Allocate(memRequirements, m_Description.GetVkMemoryPropertyFlags());
 
-    if (vkAllocateMemory(device, &allocInfo, nullptr, &m_BufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate vertex buffer memory!");
-    }
+    vkBindBufferMemory(device, m_Buffer, m_Allocation.Memory, m_Allocation.Offset);
 
-    //Associate m_BufferMemory with m_Buffer
-    vkBindBufferMemory(device, m_Buffer, m_BufferMemory, 0);
+    if (m_Description.MemoryType == BufferMemoryType::PersistentlyMapped)
+        m_MappedData = allocator.Map(m_Allocation);
 }
 
 Buffer::~Buffer() {
 	VkDevice device = Device::Get().GetDevice();
 	vkDestroyBuffer(device, m_Buffer, nullptr);
-	vkFreeMemory(device, m_BufferMemory, nullptr);
+
+	if (m_MappedData != nullptr)
+		Device::Get().GetAllocator().Unmap(m_Allocation);
+	Device::Get().GetAllocator().Free(m_Allocation);
 }
 
-void Buffer::SetData(const void* data, uint64_t size) {
-    VkDevice device = Device::Get().GetDevice();
+void Buffer::SetData(const void* data, uint64_t size, uint64_t offset) {
+    PROFILE_FUNCTION();
+
+    if (offset + size > m_Description.Size) {
+        throw std::runtime_error("buffer write out of range!");
+    }
+
+    //Device local memory can't be mapped, the copy is recorded and submitted with the next staging flush
+    if (m_Description.MemoryType == BufferMemoryType::DeviceLocal) {
+        Device::Get().GetStagingBuffer().UploadBuffer(m_Buffer, offset, data, size);
+        return;
+    }
+
+    if (m_MappedData != nullptr) {
+        memcpy(static_cast<char*>(m_MappedData) + offset, data, size);
+        Flush(offset, size);
+        return;
+    }
+
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
 
-	void* bufferData;
-	vkMapMemory(device, m_BufferMemory, 0, size, 0, &bufferData);
-	memcpy(bufferData, data, size);
-	vkUnmapMemory(device, m_BufferMemory);
+	void* bufferData = allocator.Map(m_Allocation);
+	memcpy(static_cast<char*>(bufferData) + offset, data, size);
+	allocator.Unmap(m_Allocation);
 }
 
-void Buffer::Bind(VkCommandBuffer commandBuffer) {
-    VkBuffer vertexBuffers[] = { m_Buffer };
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+void Buffer::SetIndices(const uint16_t* indices, uint32_t count) {
+    if (m_Description.Type != BufferType::IndexBuffer) {
+        throw std::runtime_error("indices can only be set on an index buffer!");
+    }
+
+    SetData(indices, count * sizeof(uint16_t));
+    m_IndexType = VK_INDEX_TYPE_UINT16;
+    m_IndexCount = count;
 }
 
-uint32_t Buffer::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-    VkPhysicalDevice physicalDevice = Device::Get().GetPhysicalDevice();
+void Buffer::SetIndices(const uint32_t* indices, uint32_t count) {
+    if (m_Description.Type != BufferType::IndexBuffer) {
+        throw std::runtime_error("indices can only be set on an index buffer!");
+    }
 
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    //Half the index fetch bandwidth when the mesh is small enough, 0xFFFF is left out since it is the restart index
+    uint32_t maxIndex = 0;
+    for (uint32_t i = 0; i < count; i++)
+        maxIndex = (std::max)(maxIndex, indices[i]);
 
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
+    if (maxIndex < 0xFFFF) {
+        std::vector<uint16_t> narrowIndices(indices, indices + count);
+        SetIndices(narrowIndices.data(), count);
+        return;
     }
 
-    throw std::runtime_error("failed to find suitable memory type!");
+    SetData(indices, count * sizeof(uint32_t));
+    m_IndexType = VK_INDEX_TYPE_UINT32;
+    m_IndexCount = count;
+}
+
+void Buffer::Flush(uint64_t offset, uint64_t size) {
+    Device::Get().GetAllocator().Flush(m_Allocation, offset, size);
+}
+
+void Buffer::Invalidate(uint64_t offset, uint64_t size) {
+    Device::Get().GetAllocator().Invalidate(m_Allocation, offset, size);
+}
+
+void Buffer::Bind(VkCommandBuffer commandBuffer, uint32_t binding) {
+    switch (m_Description.Type) {
+        case BufferType::VertexBuffer: {
+            VkBuffer vertexBuffers[] = { m_Buffer };
+            VkDeviceSize offsets[] = { 0 };
+            vkCmdBindVertexBuffers(commandBuffer, binding, 1, vertexBuffers, offsets);
+            break;
+        }
+        case BufferType::IndexBuffer:
+            vkCmdBindIndexBuffer(commandBuffer, m_Buffer, 0, m_IndexType);
+            break;
+        default:
+            throw std::runtime_error("only vertex and index buffers can be bound directly!");
+    }
 }
@@ -3,6 +3,10 @@
 
 #include <stdexcept>
 #include <vector>
+#include <string>
+#include <algorithm>
+
+#include "VkMemoryAllocator.h"
 
 enum class BufferType {
 	VertexBuffer,
@@ -11,6 +15,19 @@ enum class BufferType {
 	StorageBuffer
 };
 
+enum class BufferMemoryType {
+	HostVisible,	//Written directly by the CPU, read by the GPU over the bus
+	DeviceLocal,	//Filled through the staging buffer, fastest for the GPU to read
+	PersistentlyMapped	//Mapped once at creation and written in place, for data that changes every frame
+};
+
+//How BufferLayout places its elements, std140/std430 match GLSL uniform and storage block rules
+enum class BufferLayoutPacking {
+	Packed,
+	Std140,
+	Std430
+};
+
 enum class ShaderDataType {
 	None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, UInt, Int, Int2, Int3, Int4, Bool
 };
@@ -40,13 +57,14 @@ struct BufferElement {
 	ShaderDataType Type;
 	uint32_t Size;
 	size_t Offset;
+	uint32_t ColumnStride;
 	uint32_t InstancedDivisor;
 	bool Normalized;
 
 	BufferElement() = default;
 
 	BufferElement(ShaderDataType type, const std::string& name, uint32_t instancedDivisor = 0, bool normalized = false)
-		: Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), InstancedDivisor(instancedDivisor), Normalized(normalized) { }
+		: Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), ColumnStride(0), InstancedDivisor(instancedDivisor), Normalized(normalized) { }
 
 	VkFormat GetVulkanType() const {
 		switch (Type) {
@@ -55,8 +73,8 @@ struct BufferElement {
 			case ShaderDataType::Float2:	return VK_FORMAT_R32G32_SFLOAT;
 			case ShaderDataType::Float3:	return VK_FORMAT_R32G32B32_SFLOAT;
 			case ShaderDataType::Float4:	return VK_FORMAT_R32G32B32A32_SFLOAT;
-			case ShaderDataType::Mat3:		break;
-			case ShaderDataType::Mat4:		break;
+			case ShaderDataType::Mat3:		return VK_FORMAT_R32G32B32_SFLOAT;	//Per column
+			case ShaderDataType::Mat4:		return VK_FORMAT_R32G32B32A32_SFLOAT;	//Per column
 			case ShaderDataType::UInt:		return VK_FORMAT_R32_UINT;
 			case ShaderDataType::Int:		return VK_FORMAT_R32_SINT;
 			case ShaderDataType::Int2:		return VK_FORMAT_R32G32_SINT;
@@ -88,19 +106,74 @@ struct BufferElement {
 		std::runtime_error("Unknown ShaderDataType!");
 		return 0;
 	}
+
+	//Matrices take up one attribute location per column
+	uint32_t GetLocationCount() const {
+		switch (Type) {
+			case ShaderDataType::Mat3:	return 3;
+			case ShaderDataType::Mat4:	return 4;
+			default:					return 1;
+		}
+	}
+
+	uint32_t GetAlignment(BufferLayoutPacking packing) const {
+		if (packing == BufferLayoutPacking::Packed)
+			return 1;
+
+		switch (Type) {
+			case ShaderDataType::Float2:
+			case ShaderDataType::Int2:	return 8;
+			case ShaderDataType::Float3:
+			case ShaderDataType::Float4:
+			case ShaderDataType::Int3:
+			case ShaderDataType::Int4:
+			case ShaderDataType::Mat3:
+			case ShaderDataType::Mat4:	return 16;
+			default:					return 4;
+		}
+	}
+
+	//Size including the column padding the packing adds, a std140/std430 mat3 is three vec4 columns
+	uint32_t GetPackedSize(BufferLayoutPacking packing) const {
+		if (packing == BufferLayoutPacking::Packed)
+			return ShaderDataTypeSize(Type);
+
+		switch (Type) {
+			case ShaderDataType::Mat3:	return 16 * 3;
+			case ShaderDataType::Bool:	return 4;
+			default:					return ShaderDataTypeSize(Type);
+		}
+	}
 };
 
 class BufferLayout {
 public:
 	BufferLayout() = default;
 
-	BufferLayout(std::initializer_list<BufferElement> elements) : m_Elements(elements) {
+	BufferLayout(std::initializer_list<BufferElement> elements, BufferLayoutPacking packing = BufferLayoutPacking::Packed)
+		: m_Elements(elements), m_Packing(packing) {
 		CalculateOffsetsAndStride();
 	}
 
 	inline uint32_t GetStride() const { return m_Stride; }
+	inline BufferLayoutPacking GetPacking() const { return m_Packing; }
 	inline const std::vector<BufferElement>& GetElements() const { return m_Elements; }
 
+	//The input rate belongs to the binding, so every element of a layout has to step at the same rate
+	VkVertexInputRate GetInputRate() const {
+		uint32_t divisor = m_Elements.empty() ? 0 : m_Elements[0].InstancedDivisor;
+		for (const auto& element : m_Elements) {
+			if (element.InstancedDivisor != divisor)
+				throw std::runtime_error("all elements of a buffer layout must use the same instanced divisor!");
+		}
+
+		//Divisors above 1 need VK_EXT_vertex_attribute_divisor
+		if (divisor > 1)
+			throw std::runtime_error("instanced divisors above 1 are not supported!");
+
+		return divisor == 0 ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE;
+	}
+
 	std::vector<BufferElement>::iterator begin() { return m_Elements.begin(); }
 	std::vector<BufferElement>::iterator end() { return m_Elements.end(); }
 	std::vector<BufferElement>::const_iterator begin() const { return m_Elements.begin(); }
@@ -109,20 +182,32 @@ private:
 	//Loops through all of the elemets that are passed into this class and calculates the offset and stride automatically
 	void CalculateOffsetsAndStride() {
 		size_t offset = 0;
-		m_Stride = 0;
+		uint32_t maxAlignment = 1;
 		for (auto& element : m_Elements) {
-			element.Offset = offset;
-			offset += element.Size;
-			m_Stride += element.Size;
+			uint32_t alignment = element.GetAlignment(m_Packing);
+			maxAlignment = (std::max)(maxAlignment, alignment);
+
+			element.Size = element.GetPackedSize(m_Packing);
+			element.ColumnStride = element.Size / element.GetLocationCount();
+			element.Offset = (offset + alignment - 1) / alignment * alignment;
+			offset = element.Offset + element.Size;
 		}
+
+		//std140 rounds structs up to a vec4, std430 only to their largest member
+		if (m_Packing == BufferLayoutPacking::Std140)
+			maxAlignment = (std::max)(maxAlignment, 16u);
+
+		m_Stride = static_cast<uint32_t>((offset + maxAlignment - 1) / maxAlignment * maxAlignment);
 	}
 
 	std::vector<BufferElement> m_Elements;
+	BufferLayoutPacking m_Packing = BufferLayoutPacking::Packed;
 	uint32_t m_Stride = 0;
 };
 
 struct BufferDescription {
 	BufferType Type;
+	BufferMemoryType MemoryType = BufferMemoryType::HostVisible;
 	uint64_t Size;
 
 	BufferLayout Layout;
@@ -137,6 +222,25 @@ struct BufferDescription {
 
 		std::runtime_error("BufferType not supported");
 	}
+
+	VkBufferUsageFlags GetVkBufferUsageFlags() {
+		VkBufferUsageFlags usage = GetVkBufferUsageFlagBits();
+		if (MemoryType == BufferMemoryType::DeviceLocal)
+			usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+		return usage;
+	}
+
+	VkMemoryPropertyFlags GetVkMemoryPropertyFlags() const {
+		switch (MemoryType) {
+			case BufferMemoryType::HostVisible:	return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			case BufferMemoryType::DeviceLocal:	return VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			case BufferMemoryType::PersistentlyMapped: return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		}
+
+		throw std::runtime_error("BufferMemoryType not supported");
+		return 0;
+	}
 };
 
 class Buffer {
@@ -144,15 +248,39 @@ public:
 	Buffer(BufferDescription description);
 	~Buffer();
 
-	void SetData(const void* data, uint64_t size);
-	void Bind(VkCommandBuffer commandBuffer);
+	void SetData(const void* data, uint64_t size, uint64_t offset = 0);
+
+	//Index buffers only, 32 bit indices are stored as 16 bit when every index fits
+	void SetIndices(const uint16_t* indices, uint32_t count);
+	void SetIndices(const uint32_t* indices, uint32_t count);
+
+	//Binds as a vertex or index buffer depending on the buffer type, binding is the pipeline's vertex binding for vertex buffers
+	void Bind(VkCommandBuffer commandBuffer, uint32_t binding = 0);
+
+	//Typed pointer to count elements at offset bytes into a persistently mapped buffer, Flush the range once written
+	template<typename T>
+	T* GetWritePointer(uint64_t offset = 0, uint64_t count = 1) {
+		if (m_MappedData == nullptr || offset + count * sizeof(T) > m_Description.Size)
+			throw std::runtime_error("buffer range is not mapped!");
+
+		return reinterpret_cast<T*>(static_cast<char*>(m_MappedData) + offset);
+	}
+
+	//Make CPU writes visible to the GPU / GPU writes visible to the CPU, only needed on non coherent memory
+	void Flush(uint64_t offset, uint64_t size);
+	void Invalidate(uint64_t offset, uint64_t size);
 
 	const BufferDescription& GetDescription() const { return m_Description; }
-private:
-	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+	VkBuffer GetBuffer() const { return m_Buffer; }
+	VkIndexType GetIndexType() const { return m_IndexType; }
+	uint32_t GetIndexCount() const { return m_IndexCount; }
 private:
 	VkBuffer m_Buffer;
-	VkDeviceMemory m_BufferMemory;
+	MemoryAllocation m_Allocation;
+	void* m_MappedData = nullptr;
+
+	VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+	uint32_t m_IndexCount = 0;
 
 	BufferDescription m_Description;
 };
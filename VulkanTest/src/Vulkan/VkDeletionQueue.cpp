@@ -0,0 +1,50 @@
+#include "VkDeletionQueue.h"
+
+void DeletionQueue::Push(std::function<void()>&& destroy) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.push_back({ m_SubmittedFrames, std::move(destroy) });
+}
+
+void DeletionQueue::OnFrameSubmitted() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_SubmittedFrames++;
+}
+
+void DeletionQueue::Collect(uint64_t completedFrames) {
+    //Run outside the lock, destroying an object may push more entries
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        //Entries are pushed in frame order, so the first one still in use ends the search
+        while (!m_Entries.empty() && m_Entries.front().Frame < completedFrames) {
+            ready.push_back(std::move(m_Entries.front().Destroy));
+            m_Entries.pop_front();
+        }
+    }
+
+    for (auto& destroy : ready)
+        destroy();
+}
+
+void DeletionQueue::Flush() {
+    //Entries pushed while flushing are destroyed as well
+    while (true) {
+        std::deque<Entry> entries;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            entries.swap(m_Entries);
+        }
+
+        if (entries.empty())
+            break;
+
+        for (auto& entry : entries)
+            entry.Destroy();
+    }
+}
+
+size_t DeletionQueue::GetPendingCount() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Entries.size();
+}
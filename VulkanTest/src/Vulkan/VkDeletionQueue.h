@@ -0,0 +1,37 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//Holds on to the destruction of objects that frames already submitted, or the one being recorded, may still use.
+//Replaces waiting for the whole device to go idle when something has to be rebuilt in the middle of rendering.
+//Push may be called from any thread, e.g. when a compile thread drops the last reference to a pipeline.
+class DeletionQueue {
+public:
+	//destroy runs once the frame currently being recorded and every frame before it have finished on the GPU
+	void Push(std::function<void()>&& destroy);
+
+	void OnFrameSubmitted();
+
+	//completedFrames is how many submitted frames are known to have finished
+	void Collect(uint64_t completedFrames);
+
+	//Only call this when the device is idle
+	void Flush();
+
+	size_t GetPendingCount();
+private:
+	struct Entry {
+		uint64_t Frame;
+		std::function<void()> Destroy;
+	};
+
+	std::deque<Entry> m_Entries;
+	uint64_t m_SubmittedFrames = 0;
+
+	std::mutex m_Mutex;
+};
+
@@ -0,0 +1,229 @@
+#include "VkDescriptorSet.h"
+
+#include <algorithm>
+
+#include "VkDevice.h"
+
+DescriptorSetLayout::DescriptorSetLayout(std::vector<DescriptorBinding> bindings)
+    : m_Bindings(std::move(bindings)) {
+    //Dynamic offsets are consumed in binding order
+    std::sort(m_Bindings.begin(), m_Bindings.end(), [](const DescriptorBinding& a, const DescriptorBinding& b) { return a.Binding < b.Binding; });
+
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+    std::vector<VkDescriptorBindingFlags> bindingFlags;
+    bool hasBindingFlags = false;
+    for (const auto& binding : m_Bindings) {
+        VkDescriptorSetLayoutBinding layoutBinding{};
+        layoutBinding.binding = binding.Binding;
+        layoutBinding.descriptorType = GetVkDescriptorType(binding.Type);
+        layoutBinding.descriptorCount = binding.Count;
+        layoutBinding.stageFlags = binding.Stages;
+        layoutBinding.pImmutableSamplers = nullptr;
+
+        layoutBindings.push_back(layoutBinding);
+        bindingFlags.push_back(binding.Flags);
+        hasBindingFlags |= binding.Flags != 0;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+    layoutInfo.pBindings = layoutBindings.data();
+
+    //Only chained when used, so layouts without flags don't need descriptor indexing
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    if (hasBindingFlags) {
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+        layoutInfo.pNext = &bindingFlagsInfo;
+
+        if (IsUpdateAfterBind())
+            layoutInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    }
+
+    if (vkCreateDescriptorSetLayout(Device::Get().GetDevice(), &layoutInfo, nullptr, &m_Layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+}
+
+DescriptorSetLayout::~DescriptorSetLayout() {
+    vkDestroyDescriptorSetLayout(Device::Get().GetDevice(), m_Layout, nullptr);
+}
+
+const DescriptorBinding& DescriptorSetLayout::GetBinding(uint32_t binding) const {
+    for (const auto& descriptorBinding : m_Bindings) {
+        if (descriptorBinding.Binding == binding)
+            return descriptorBinding;
+    }
+
+    throw std::runtime_error("descriptor set layout has no such binding!");
+}
+
+uint32_t DescriptorSetLayout::GetDynamicOffsetCount() const {
+    uint32_t count = 0;
+    for (const auto& binding : m_Bindings) {
+        if (binding.Type == DescriptorType::UniformBufferDynamic || binding.Type == DescriptorType::StorageBufferDynamic)
+            count += binding.Count;
+    }
+
+    return count;
+}
+
+bool DescriptorSetLayout::IsUpdateAfterBind() const {
+    for (const auto& binding : m_Bindings) {
+        if (binding.Flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT)
+            return true;
+    }
+
+    return false;
+}
+
+void DescriptorAllocator::Init(VkDevice device) {
+    m_Device = device;
+}
+
+void DescriptorAllocator::Shutdown() {
+    for (VkDescriptorPool pool : m_Pools)
+        vkDestroyDescriptorPool(m_Device, pool, nullptr);
+
+    m_Pools.clear();
+}
+
+DescriptorAllocation DescriptorAllocator::Allocate(const DescriptorSetLayout& layout) {
+    if (layout.IsUpdateAfterBind()) {
+        throw std::runtime_error("update after bind layouts can't be allocated from the shared descriptor pools!");
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    VkDescriptorSetLayout setLayout = layout.GetLayout();
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+
+    DescriptorAllocation allocation{};
+
+    //Newest pool first, older ones only have room left if sets were freed from them
+    for (auto it = m_Pools.rbegin(); it != m_Pools.rend(); ++it) {
+        allocInfo.descriptorPool = *it;
+
+        VkResult result = vkAllocateDescriptorSets(m_Device, &allocInfo, &allocation.Set);
+        if (result == VK_SUCCESS) {
+            allocation.Pool = *it;
+            return allocation;
+        }
+
+        if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+            throw std::runtime_error("failed to allocate descriptor set!");
+        }
+    }
+
+    allocInfo.descriptorPool = CreatePool();
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, &allocation.Set) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate descriptor set!");
+    }
+
+    allocation.Pool = allocInfo.descriptorPool;
+    return allocation;
+}
+
+void DescriptorAllocator::Free(DescriptorAllocation& allocation) {
+    if (allocation.Set == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    vkFreeDescriptorSets(m_Device, allocation.Pool, 1, &allocation.Set);
+
+    allocation = {};
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool() {
+    //Enough for SETS_PER_POOL sets of a few buffers and images each
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SETS_PER_POOL },
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, SETS_PER_POOL },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SETS_PER_POOL },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, SETS_PER_POOL / 4 },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, SETS_PER_POOL * 2 }
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.maxSets = SETS_PER_POOL;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    m_Pools.push_back(pool);
+    return pool;
+}
+
+DescriptorSet::DescriptorSet(std::shared_ptr<DescriptorSetLayout> layout)
+    : m_Layout(std::move(layout)) {
+    m_Allocation = Device::Get().GetDescriptorAllocator().Allocate(*m_Layout);
+}
+
+DescriptorSet::~DescriptorSet() {
+    //Frames in flight may still be reading the set, the layout has to outlive it as well
+    DescriptorAllocation allocation = m_Allocation;
+    std::shared_ptr<DescriptorSetLayout> layout = m_Layout;
+    Device::Get().GetDeletionQueue().Push([allocation, layout]() mutable {
+        Device::Get().GetDescriptorAllocator().Free(allocation);
+    });
+}
+
+void DescriptorSet::WriteBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t arrayElement) {
+    const DescriptorBinding& descriptorBinding = m_Layout->GetBinding(binding);
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_Allocation.Set;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = arrayElement;
+    descriptorWrite.descriptorType = GetVkDescriptorType(descriptorBinding.Type);
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(Device::Get().GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void DescriptorSet::WriteImage(uint32_t binding, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout, uint32_t arrayElement) {
+    const DescriptorBinding& descriptorBinding = m_Layout->GetBinding(binding);
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = imageView;
+    imageInfo.sampler = sampler;
+    imageInfo.imageLayout = imageLayout;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_Allocation.Set;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = arrayElement;
+    descriptorWrite.descriptorType = GetVkDescriptorType(descriptorBinding.Type);
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(Device::Get().GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void DescriptorSet::Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t setIndex, const uint32_t* dynamicOffsets, uint32_t dynamicOffsetCount) const {
+    if (dynamicOffsetCount != m_Layout->GetDynamicOffsetCount()) {
+        throw std::runtime_error("descriptor set needs one dynamic offset per dynamic binding!");
+    }
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, setIndex, 1, &m_Allocation.Set, dynamicOffsetCount, dynamicOffsets);
+}
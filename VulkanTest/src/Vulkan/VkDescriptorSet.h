@@ -0,0 +1,113 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+enum class DescriptorType {
+	UniformBuffer,
+	UniformBufferDynamic,	//The offset is given when binding, so one set covers every allocation out of a buffer
+	StorageBuffer,
+	StorageBufferDynamic,
+	CombinedImageSampler,
+	SampledImage,
+	Sampler
+};
+
+static VkDescriptorType GetVkDescriptorType(DescriptorType type) {
+	switch (type) {
+		case DescriptorType::UniformBuffer:			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		case DescriptorType::UniformBufferDynamic:	return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		case DescriptorType::StorageBuffer:			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		case DescriptorType::StorageBufferDynamic:	return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		case DescriptorType::CombinedImageSampler:	return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		case DescriptorType::SampledImage:			return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		case DescriptorType::Sampler:				return VK_DESCRIPTOR_TYPE_SAMPLER;
+	}
+
+	throw std::runtime_error("DescriptorType not supported");
+}
+
+struct DescriptorBinding {
+	uint32_t Binding = 0;
+	DescriptorType Type = DescriptorType::UniformBuffer;
+	VkShaderStageFlags Stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	uint32_t Count = 1;
+
+	//VkDescriptorBindingFlags from descriptor indexing, sets of a layout using UPDATE_AFTER_BIND need a pool created for it
+	VkDescriptorBindingFlags Flags = 0;
+};
+
+//Shared between the pipelines declaring it and the sets allocated with it, a set can be bound to any pipeline
+//whose layout has an identical set layout at that index
+class DescriptorSetLayout {
+public:
+	DescriptorSetLayout(std::vector<DescriptorBinding> bindings);
+	~DescriptorSetLayout();
+
+	DescriptorSetLayout(const DescriptorSetLayout&) = delete;
+	DescriptorSetLayout& operator=(const DescriptorSetLayout&) = delete;
+
+	const std::vector<DescriptorBinding>& GetBindings() const { return m_Bindings; }
+	const DescriptorBinding& GetBinding(uint32_t binding) const;
+	uint32_t GetDynamicOffsetCount() const;
+	bool IsUpdateAfterBind() const;
+
+	VkDescriptorSetLayout GetLayout() const { return m_Layout; }
+private:
+	std::vector<DescriptorBinding> m_Bindings;
+	VkDescriptorSetLayout m_Layout = VK_NULL_HANDLE;
+};
+
+struct DescriptorAllocation {
+	VkDescriptorSet Set = VK_NULL_HANDLE;
+	VkDescriptorPool Pool = VK_NULL_HANDLE;
+};
+
+//Hands out descriptor sets from a growing list of pools, a new pool is only created once every existing one is full
+class DescriptorAllocator {
+public:
+	void Init(VkDevice device);
+	void Shutdown();
+
+	DescriptorAllocation Allocate(const DescriptorSetLayout& layout);
+
+	//The set must not be used by any frame still in flight anymore
+	void Free(DescriptorAllocation& allocation);
+
+	uint32_t GetPoolCount() const { return static_cast<uint32_t>(m_Pools.size()); }
+public:
+	static const uint32_t SETS_PER_POOL = 256;
+private:
+	VkDescriptorPool CreatePool();
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	std::vector<VkDescriptorPool> m_Pools;
+
+	std::mutex m_Mutex;
+};
+
+//A set allocated from the device's descriptor allocator, freed through the deletion queue once no frame uses it anymore
+class DescriptorSet {
+public:
+	DescriptorSet(std::shared_ptr<DescriptorSetLayout> layout);
+	~DescriptorSet();
+
+	DescriptorSet(const DescriptorSet&) = delete;
+	DescriptorSet& operator=(const DescriptorSet&) = delete;
+
+	//For dynamic bindings offset is the base the dynamic offsets are added to and range the size visible to the shader
+	void WriteBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t arrayElement = 0);
+	void WriteImage(uint32_t binding, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, uint32_t arrayElement = 0);
+
+	//dynamicOffsets needs one entry per dynamic binding, in binding order
+	void Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t setIndex, const uint32_t* dynamicOffsets = nullptr, uint32_t dynamicOffsetCount = 0) const;
+
+	const std::shared_ptr<DescriptorSetLayout>& GetLayout() const { return m_Layout; }
+	VkDescriptorSet GetSet() const { return m_Allocation.Set; }
+private:
+	std::shared_ptr<DescriptorSetLayout> m_Layout;
+	DescriptorAllocation m_Allocation;
+};
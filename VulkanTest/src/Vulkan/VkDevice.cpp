@@ -2,6 +2,8 @@
 
 #include <set>
 #include <algorithm>
+#include <cstring>
+#include <cstdlib>
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -23,20 +25,46 @@ void Device::Init(GLFWwindow* windowHandle) {
     CreateSurface();
     PickPhysicalDevice();
     CreateLogicalDevice();
+
+    m_Allocator.Init(m_Device, m_PhysicalDevice);
+    m_StagingBuffer.Init();
+    m_PipelineCache.Init(m_Device, m_PhysicalDevice);
+    m_DescriptorAllocator.Init(m_Device);
+    m_SamplerCache.Init(m_Device, m_PhysicalDevice);
 }
 
 void Device::Shutdown() {
+    //Whatever the renderer retired last still holds memory from the allocator
+    vkDeviceWaitIdle(m_Device);
+    m_DeletionQueue.Flush();
+
+    m_SamplerCache.Shutdown();
+    m_DescriptorAllocator.Shutdown();
+    m_PipelineCache.Shutdown();
+    m_StagingBuffer.Shutdown();
+    m_Allocator.Shutdown();
+
     vkDestroyDevice(m_Device, nullptr);
 
     if (m_EnableValidationLayers) {
         DestroyDebugUtilsMessengerEXT(m_Instance, m_DebugMessenger, nullptr);
     }
-    vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+    if (m_Surface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
     vkDestroyInstance(m_Instance, nullptr);
 }
 
 void Device::SwapBuffers() {
-    m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_CurrentFrame = (m_CurrentFrame + 1) % m_FramesInFlight;
+}
+
+void Device::SetFramesInFlight(uint32_t framesInFlight) {
+    if (framesInFlight < 1 || framesInFlight > MAX_FRAMES_IN_FLIGHT) {
+        throw std::runtime_error("frames in flight must be between 1 and MAX_FRAMES_IN_FLIGHT!");
+    }
+
+    m_FramesInFlight = framesInFlight;
+    m_CurrentFrame = 0;
 }
 
 void Device::CreateVkInstance() {
@@ -47,7 +75,15 @@ void Device::CreateVkInstance() {
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    //1.0 loaders reject any other version, newer ones are asked for 1.2 so descriptor indexing can be used as core
+    m_InstanceVersion = VK_API_VERSION_1_0;
+    auto enumerateInstanceVersion = (PFN_vkEnumerateInstanceVersion)vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion");
+    if (enumerateInstanceVersion != nullptr) {
+        uint32_t loaderVersion = VK_API_VERSION_1_0;
+        enumerateInstanceVersion(&loaderVersion);
+        m_InstanceVersion = (std::min)(loaderVersion, (uint32_t)VK_API_VERSION_1_2);
+    }
+    appInfo.apiVersion = m_InstanceVersion;
 
     //Create info with app info inside
     VkInstanceCreateInfo createInfo{};
@@ -90,10 +126,22 @@ void Device::SetupDebugMessenger() {
 }
 
 void Device::CreateSurface() {
+    if (IsHeadless()) return;
+
     if (glfwCreateWindowSurface(m_Instance, m_WindowHandle, nullptr, &m_Surface) != VK_SUCCESS)
         throw std::runtime_error("failed to create window surface!");
 }
 
+static const char* GetDeviceTypeName(VkPhysicalDeviceType type) {
+    switch (type) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:      return "discrete";
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:    return "integrated";
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:       return "virtual";
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:               return "cpu";
+        default:                                        return "other";
+    }
+}
+
 void Device::PickPhysicalDevice() {
     uint32_t deviceCount = 0;
     vkEnumeratePhysicalDevices(m_Instance, &deviceCount, nullptr);
@@ -103,16 +151,53 @@ void Device::PickPhysicalDevice() {
     std::vector<VkPhysicalDevice> devices(deviceCount);
     vkEnumeratePhysicalDevices(m_Instance, &deviceCount, devices.data());
 
-    for (const auto& device : devices) {
-        if (IsDeviceSuitable(device)) {
-            m_PhysicalDevice = device;
-            break;
+    const char* deviceOverride = std::getenv(DEVICE_OVERRIDE_VARIABLE);
+    if (deviceOverride != nullptr && deviceOverride[0] == '\0')
+        deviceOverride = nullptr;
+
+    uint64_t bestScore = 0;
+    bool overridden = false;
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(devices[i], &properties);
+
+        std::string reason;
+        if (!IsDeviceSuitable(devices[i], reason)) {
+            std::cout << "device " << i << ": " << properties.deviceName << " rejected, " << reason << std::endl;
+            continue;
+        }
+
+        uint64_t score = ScoreDevice(devices[i]);
+        std::cout << "device " << i << ": " << properties.deviceName << " (" << GetDeviceTypeName(properties.deviceType) << ") scored " << score << std::endl;
+
+        bool matchesOverride = deviceOverride != nullptr
+            && (std::to_string(i) == deviceOverride || strstr(properties.deviceName, deviceOverride) != nullptr);
+
+        if (matchesOverride && !overridden) {
+            m_PhysicalDevice = devices[i];
+            overridden = true;
+        }
+        else if (!overridden && (m_PhysicalDevice == VK_NULL_HANDLE || score > bestScore)) {
+            m_PhysicalDevice = devices[i];
+            bestScore = score;
         }
     }
 
     if (m_PhysicalDevice == VK_NULL_HANDLE) {
         throw std::runtime_error("failed to find a suitable GPU!");
     }
+
+    if (deviceOverride != nullptr && !overridden)
+        std::cout << DEVICE_OVERRIDE_VARIABLE << "=" << deviceOverride << " matched no suitable device, falling back to the highest score" << std::endl;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+    std::cout << "device: using " << properties.deviceName << (overridden ? " (selected by " + std::string(DEVICE_OVERRIDE_VARIABLE) + ")" : std::string(" (highest score)")) << std::endl;
+
+    //Suitability checks ran for every device, make sure what's kept belongs to the chosen one
+    FindQueueFamilies(m_PhysicalDevice);
+    if (!IsHeadless())
+        m_SwapChainSupport = QuerySwapChainSupport(m_PhysicalDevice);
 }
 
 void Device::CreateLogicalDevice() {
@@ -131,7 +216,13 @@ void Device::CreateLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+
+    //Needed for wireframe pipelines and anisotropic texture filtering
+    m_EnabledFeatures = {};
+    m_EnabledFeatures.fillModeNonSolid = supportedFeatures.fillModeNonSolid;
+    m_EnabledFeatures.samplerAnisotropy = supportedFeatures.samplerAnisotropy;
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -139,10 +230,74 @@ void Device::CreateLogicalDevice() {
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pEnabledFeatures = &m_EnabledFeatures;
+
+    m_EnabledDeviceExtensions = GetRequiredDeviceExtensions();
+
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+    auto isExtensionAvailable = [&availableExtensions](const char* extensionName) {
+        return std::any_of(availableExtensions.begin(), availableExtensions.end(), [extensionName](const VkExtensionProperties& extension) {
+            return strcmp(extension.extensionName, extensionName) == 0;
+        });
+    };
+
+    for (const char* extensionName : m_OptionalDeviceExtensions) {
+        if (isExtensionAvailable(extensionName))
+            m_EnabledDeviceExtensions.push_back(extensionName);
+    }
+
+    //Descriptor indexing is core since 1.2 and an extension on 1.1, features of either are queried through vkGetPhysicalDeviceFeatures2
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &properties);
+    m_ApiVersion = (std::min)(properties.apiVersion, m_InstanceVersion);
 
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_DeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = m_DeviceExtensions.data();
+    const bool descriptorIndexingCore = m_ApiVersion >= VK_API_VERSION_1_2;
+    const bool descriptorIndexingExtension = !descriptorIndexingCore && m_ApiVersion >= VK_API_VERSION_1_1 && isExtensionAvailable(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+    VkPhysicalDeviceDescriptorIndexingFeatures supportedIndexing{};
+    supportedIndexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+    if (descriptorIndexingCore || descriptorIndexingExtension) {
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &supportedIndexing;
+        vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+    }
+
+    //Sampled image and storage buffer arrays that are written while bound and only partially filled, and textures
+    //indexed per object, which needs non uniform indexing as soon as a draw covers more than one object
+    m_BindlessSupported = supportedIndexing.runtimeDescriptorArray && supportedIndexing.descriptorBindingPartiallyBound &&
+        supportedIndexing.descriptorBindingUpdateUnusedWhilePending &&
+        supportedIndexing.descriptorBindingSampledImageUpdateAfterBind && supportedIndexing.descriptorBindingStorageBufferUpdateAfterBind &&
+        supportedIndexing.shaderSampledImageArrayNonUniformIndexing;
+
+    m_DescriptorIndexingFeatures = {};
+    m_DescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+    if (m_BindlessSupported) {
+        m_DescriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        m_DescriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        m_DescriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        m_DescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        m_DescriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+
+        m_DescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
+        //Optional, without it a shader's buffer index has to be the same for the whole draw
+        m_DescriptorIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing = supportedIndexing.shaderStorageBufferArrayNonUniformIndexing;
+
+        createInfo.pNext = &m_DescriptorIndexingFeatures;
+        if (descriptorIndexingExtension)
+            m_EnabledDeviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_EnabledDeviceExtensions.size());
+    createInfo.ppEnabledExtensionNames = m_EnabledDeviceExtensions.data();
 
     if (m_EnableValidationLayers) {
         createInfo.enabledLayerCount = static_cast<uint32_t>(m_ValidationLayers.size());
@@ -160,12 +315,26 @@ void Device::CreateLogicalDevice() {
     vkGetDeviceQueue(m_Device, indices.PresentFamily.value(), 0, &m_PresentQueue);
 }
 
+bool Device::IsExtensionEnabled(const char* extensionName) {
+    for (const char* extension : m_EnabledDeviceExtensions) {
+        if (strcmp(extension, extensionName) == 0)
+            return true;
+    }
+
+    return false;
+}
+
 std::vector<const char*> Device::GetRequiredExtensions() {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    //Headless runs don't even initialize GLFW, there is no display to present to
+    if (!IsHeadless()) {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (m_EnableValidationLayers)
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -173,6 +342,13 @@ std::vector<const char*> Device::GetRequiredExtensions() {
     return extensions;
 }
 
+std::vector<const char*> Device::GetRequiredDeviceExtensions() {
+    if (IsHeadless())
+        return {};
+
+    return m_DeviceExtensions;
+}
+
 void Device::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
     createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
@@ -198,26 +374,70 @@ void Device::DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMess
     }
 }
 
-bool Device::IsDeviceSuitable(VkPhysicalDevice device) {
+bool Device::IsDeviceSuitable(VkPhysicalDevice device, std::string& reason) {
     QueueFamilyIndices indices = FindQueueFamilies(device);
+    if (!indices.IsComplete()) {
+        reason = indices.GraphicsFamily.has_value() ? "no queue family can present to the surface" : "no graphics queue family";
+        return false;
+    }
+
+    if (!CheckDeviceExtensionSupport(device)) {
+        reason = "missing required device extensions";
+        return false;
+    }
+
+    if (!IsHeadless()) {
+        SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
+        if (swapChainSupport.Formats.empty() || swapChainSupport.PresentModes.empty()) {
+            reason = "no surface formats or present modes";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint64_t Device::ScoreDevice(VkPhysicalDevice device) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
 
-    bool extensionsSupported = CheckDeviceExtensionSupport(device);
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(device, &features);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
-        m_SwapChainSupport = QuerySwapChainSupport(device);
-        swapChainAdequate = !m_SwapChainSupport.Formats.empty() && !m_SwapChainSupport.PresentModes.empty();
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+
+    //Device type dominates, anything else only decides between devices of the same type
+    uint64_t score = 0;
+    switch (properties.deviceType) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:      score += 100000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:    score += 50000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:       score += 25000; break;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU:               score += 10000; break;
+        default: break;
+    }
+
+    //One point per MiB of the largest device local heap, capped so VRAM can't outweigh the type
+    VkDeviceSize largestHeap = 0;
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            largestHeap = (std::max)(largestHeap, memoryProperties.memoryHeaps[i].size);
     }
+    score += (std::min)(largestHeap / (1024 * 1024), static_cast<VkDeviceSize>(9000));
 
-    VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+    score += properties.limits.maxImageDimension2D / 1024;
 
-    bool dedicatedGPU = deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+    if (features.fillModeNonSolid)
+        score += 100;
+    if (features.samplerAnisotropy)
+        score += 100;
 
-    return indices.IsComplete() && extensionsSupported && swapChainAdequate && dedicatedGPU;
+    return score;
 }
 
 QueueFamilyIndices Device::FindQueueFamilies(VkPhysicalDevice device) {
+    m_QueueFamilyIndices = {};
+
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
 
@@ -226,8 +446,12 @@ QueueFamilyIndices Device::FindQueueFamilies(VkPhysicalDevice device) {
 
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
+        //Without a surface nothing is presented, the graphics queue stands in for the present queue
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
+        if (IsHeadless())
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        else
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
 
         if (presentSupport) {
             m_QueueFamilyIndices.PresentFamily = i;
@@ -254,7 +478,8 @@ bool Device::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(m_DeviceExtensions.begin(), m_DeviceExtensions.end());
+    std::vector<const char*> deviceExtensions = GetRequiredDeviceExtensions();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
     for (const auto& extension : availableExtensions) {
         requiredExtensions.erase(extension.extensionName);
@@ -7,8 +7,15 @@
 #include <stdexcept>
 #include <iostream>
 #include <optional>
+#include <string>
 
 #include "Vulkan/VkBuffer.h"
+#include "Vulkan/VkMemoryAllocator.h"
+#include "Vulkan/VkStagingBuffer.h"
+#include "Vulkan/VkPipelineCache.h"
+#include "Vulkan/VkDeletionQueue.h"
+#include "Vulkan/VkDescriptorSet.h"
+#include "Vulkan/VkSamplerCache.h"
 
 struct QueueFamilyIndices {
     std::optional<uint32_t> GraphicsFamily;
@@ -27,6 +34,7 @@ struct SwapChainSupportDetails {
 
 class Device {
 public:
+    //A null window handle runs headless, without a surface or VK_KHR_swapchain
     void Init(GLFWwindow* windowHandle);
     void Shutdown();
 
@@ -35,21 +43,49 @@ public:
     VkDevice GetDevice() { return m_Device; }
     VkPhysicalDevice GetPhysicalDevice() { return m_PhysicalDevice; }
     VkSurfaceKHR GetSurface() { return m_Surface; }
+    bool IsHeadless() const { return m_WindowHandle == nullptr; }
 
     SwapChainSupportDetails& GetSwapChainSupport() { return m_SwapChainSupport; }
+    void RefreshSwapChainSupport() { m_SwapChainSupport = QuerySwapChainSupport(m_PhysicalDevice); }
     QueueFamilyIndices& GetQueueFamilyIndices() { return m_QueueFamilyIndices; }
 
     VkQueue GetGraphicsQueue() { return m_GraphicsQueue; }
     VkQueue GetPresentQueue() { return m_PresentQueue; }
 
+    MemoryAllocator& GetAllocator() { return m_Allocator; }
+    StagingBuffer& GetStagingBuffer() { return m_StagingBuffer; }
+    DeletionQueue& GetDeletionQueue() { return m_DeletionQueue; }
+    PipelineCache& GetPipelineCache() { return m_PipelineCache; }
+    DescriptorAllocator& GetDescriptorAllocator() { return m_DescriptorAllocator; }
+    SamplerCache& GetSamplerCache() { return m_SamplerCache; }
+
+    //Required extensions are always enabled, optional ones only when the GPU supports them
+    bool IsExtensionEnabled(const char* extensionName);
+    const VkPhysicalDeviceFeatures& GetEnabledFeatures() const { return m_EnabledFeatures; }
+
+    //The version both the instance and the physical device support
+    uint32_t GetApiVersion() const { return m_ApiVersion; }
+
+    //Update after bind, partially bound sampled image and storage buffer arrays, see BindlessHeap
+    bool IsBindlessSupported() const { return m_BindlessSupported; }
+    const VkPhysicalDeviceDescriptorIndexingFeatures& GetDescriptorIndexingFeatures() const { return m_DescriptorIndexingFeatures; }
+
     uint32_t GetCurrentFrame() { return m_CurrentFrame; }
 
+    //1 to MAX_FRAMES_IN_FLIGHT, nothing may be in flight when this changes
+    uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+    void SetFramesInFlight(uint32_t framesInFlight);
+
     static Device& Get() {
         static Device instance;
 		return instance;
 	}
 public:
-    static const int MAX_FRAMES_IN_FLIGHT = 2;
+    //Per frame resources are created for this many frames, only GetFramesInFlight of them are used
+    static const int MAX_FRAMES_IN_FLIGHT = 4;
+
+    //Set to a device index or part of a device name to pick that device regardless of its score
+    inline static const char* DEVICE_OVERRIDE_VARIABLE = "VULKAN_TEST_DEVICE";
 private:
     void CreateVkInstance();
     void SetupDebugMessenger();
@@ -58,21 +94,25 @@ private:
     void CreateLogicalDevice();
 
     std::vector<const char*> GetRequiredExtensions();
+    std::vector<const char*> GetRequiredDeviceExtensions();
 
     void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
     VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
     void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator);
 
-    //Incase you need to check if the GPU is able to run the program
-    bool IsDeviceSuitable(VkPhysicalDevice device);
+    //Incase you need to check if the GPU is able to run the program, reason says what is missing when it isn't
+    bool IsDeviceSuitable(VkPhysicalDevice device, std::string& reason);
+    //Higher is better, only meaningful for suitable devices
+    uint64_t ScoreDevice(VkPhysicalDevice device);
     QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
     SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
 private:
     uint32_t m_CurrentFrame = 0;
+    uint32_t m_FramesInFlight = 2;
 
-    GLFWwindow* m_WindowHandle;
-    VkSurfaceKHR m_Surface;
+    GLFWwindow* m_WindowHandle = nullptr;
+    VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
 
     SwapChainSupportDetails m_SwapChainSupport;
     QueueFamilyIndices m_QueueFamilyIndices;
@@ -85,6 +125,13 @@ private:
 
     VkQueue m_GraphicsQueue, m_PresentQueue;
 
+    MemoryAllocator m_Allocator;
+    StagingBuffer m_StagingBuffer;
+    DeletionQueue m_DeletionQueue;
+    PipelineCache m_PipelineCache;
+    DescriptorAllocator m_DescriptorAllocator;
+    SamplerCache m_SamplerCache;
+
 #ifdef DEBUG
     const bool m_EnableValidationLayers = true;
 #else
@@ -98,4 +145,17 @@ private:
     const std::vector<const char*> m_DeviceExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
+
+    const std::vector<const char*> m_OptionalDeviceExtensions = {
+        VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME
+    };
+
+    std::vector<const char*> m_EnabledDeviceExtensions;
+    VkPhysicalDeviceFeatures m_EnabledFeatures{};
+
+    uint32_t m_InstanceVersion = VK_API_VERSION_1_0;
+    uint32_t m_ApiVersion = VK_API_VERSION_1_0;
+
+    bool m_BindlessSupported = false;
+    VkPhysicalDeviceDescriptorIndexingFeatures m_DescriptorIndexingFeatures{};
 };
\ No newline at end of file
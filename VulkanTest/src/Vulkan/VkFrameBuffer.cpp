@@ -3,40 +3,111 @@
 #include "Application.h"
 
 #include "VkDevice.h"
+#include "Core/Instrumentor.h"
+
+#include <iostream>
+
+static const char* GetPresentModeName(VkPresentModeKHR presentMode) {
+    switch (presentMode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "Fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FifoRelaxed";
+        default: return "Unknown";
+    }
+}
 
 Framebuffer::Framebuffer(const FramebufferDescription& frameBufferSpecification) 
 	: m_FramebufferDescription(frameBufferSpecification) {
-	CreateSwapChain();
+	if (m_FramebufferDescription.SwapChainTarget)
+		CreateSwapChain(VK_NULL_HANDLE);
+	else
+		CreateColorImages();
+
 	CreateImageViews();
 	CreateRenderPass();
 	CreateFramebuffers();
 }
 
 Framebuffer::~Framebuffer() {
+    VkDevice device = Device::Get().GetDevice();
+
     CleanupSwapChain();
+
+    if (m_Swapchain != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(device, m_Swapchain, nullptr);
+
+    vkDestroyRenderPass(device, m_RenderPass, nullptr);
 }
 
 void Framebuffer::ReCreate() {
-    CleanupSwapChain();
+    PROFILE_FUNCTION();
+
+    VkDevice device = Device::Get().GetDevice();
+
+    //Frames still in flight render into the current images, so they are only destroyed once those frames are done
+    std::vector<VkFramebuffer> framebuffers;
+    std::vector<VkImageView> imageViews;
+    std::vector<VkImage> colorImages;
+    std::vector<MemoryAllocation> colorImageAllocations;
+    framebuffers.swap(m_Framebuffers);
+    imageViews.swap(m_SwapChainImageViews);
+    colorImages.swap(m_ColorImages);
+    colorImageAllocations.swap(m_ColorImageAllocations);
+
+    VkSwapchainKHR oldSwapchain = m_Swapchain;
+    VkRenderPass oldRenderPass = VK_NULL_HANDLE;
+    VkFormat oldFormat = m_SwapChainImageFormat;
+
+    //Presentation carries on with the old swapchain's images until the new ones are acquired
+    if (m_FramebufferDescription.SwapChainTarget)
+        CreateSwapChain(oldSwapchain);
+    else
+        CreateColorImages();
+
+    //The render pass only depends on the format, which hardly ever changes along with the swapchain
+    if (m_SwapChainImageFormat != oldFormat) {
+        oldRenderPass = m_RenderPass;
+        CreateRenderPass();
+    }
 
-    CreateSwapChain();
     CreateImageViews();
     CreateFramebuffers();
+
+    Device::Get().GetDeletionQueue().Push([=]() mutable {
+        for (auto framebuffer : framebuffers)
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+
+        for (auto imageView : imageViews)
+            vkDestroyImageView(device, imageView, nullptr);
+
+        MemoryAllocator& allocator = Device::Get().GetAllocator();
+        for (size_t i = 0; i < colorImages.size(); i++) {
+            vkDestroyImage(device, colorImages[i], nullptr);
+            allocator.Free(colorImageAllocations[i]);
+        }
+
+        if (oldSwapchain != VK_NULL_HANDLE)
+            vkDestroySwapchainKHR(device, oldSwapchain, nullptr);
+
+        if (oldRenderPass != VK_NULL_HANDLE)
+            vkDestroyRenderPass(device, oldRenderPass, nullptr);
+    });
 }
 
-void Framebuffer::CreateSwapChain() {
+void Framebuffer::CreateSwapChain(VkSwapchainKHR oldSwapchain) {
     VkDevice device = Device::Get().GetDevice();
     VkSurfaceKHR surface = Device::Get().GetSurface();
-    SwapChainSupportDetails swapChainSupport = Device::Get().GetSwapChainSupport();
+
+    //Capabilities like the current extent change with the window, so they are queried fresh every time
+    Device::Get().RefreshSwapChainSupport();
+    const SwapChainSupportDetails& swapChainSupport = Device::Get().GetSwapChainSupport();
 
     VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.Formats);
-    VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.PresentModes);
+    m_PresentMode = ChooseSwapPresentMode(swapChainSupport.PresentModes);
     m_SwapChainExtent = ChooseSwapExtent(swapChainSupport.Capabilities);
 
-    uint32_t imageCount = swapChainSupport.Capabilities.minImageCount + 1;
-    if (swapChainSupport.Capabilities.maxImageCount > 0 && imageCount > swapChainSupport.Capabilities.maxImageCount) {
-        imageCount = swapChainSupport.Capabilities.maxImageCount;
-    }
+    uint32_t imageCount = ChooseSwapImageCount(swapChainSupport.Capabilities, m_PresentMode);
 
     VkSwapchainCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -64,9 +135,9 @@ void Framebuffer::CreateSwapChain() {
     }
     createInfo.preTransform = swapChainSupport.Capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = presentMode;
+    createInfo.presentMode = m_PresentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = oldSwapchain;
 
     if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &m_Swapchain) != VK_SUCCESS) {
         throw std::runtime_error("failed to create swap chain!");
@@ -76,16 +147,56 @@ void Framebuffer::CreateSwapChain() {
     m_SwapChainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(device, m_Swapchain, &imageCount, m_SwapChainImages.data());
     m_SwapChainImageFormat = surfaceFormat.format;
+
+    std::cout << "swapchain: " << m_SwapChainExtent.width << "x" << m_SwapChainExtent.height << ", " << imageCount << " images, "
+        << GetPresentModeName(m_PresentMode) << " present mode" << std::endl;
+}
+
+void Framebuffer::CreateColorImages() {
+    VkDevice device = Device::Get().GetDevice();
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+
+    m_SwapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    m_SwapChainExtent = { m_FramebufferDescription.Width, m_FramebufferDescription.Height };
+
+    m_ColorImages.resize(m_FramebufferDescription.ImageCount);
+    m_ColorImageAllocations.resize(m_FramebufferDescription.ImageCount);
+
+    for (size_t i = 0; i < m_ColorImages.size(); i++) {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = m_SwapChainImageFormat;
+        imageInfo.extent = { m_SwapChainExtent.width, m_SwapChainExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &m_ColorImages[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create color image!");
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, m_ColorImages[i], &memRequirements);
+
+        m_ColorImageAllocations[i] = allocator.Allocate(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryResourceType::Optimal);
+        vkBindImageMemory(device, m_ColorImages[i], m_ColorImageAllocations[i].Memory, m_ColorImageAllocations[i].Offset);
+    }
 }
 
 void Framebuffer::CreateImageViews() {
     VkDevice device = Device::Get().GetDevice();
-    m_SwapChainImageViews.resize(m_SwapChainImages.size());
+    const std::vector<VkImage>& images = m_FramebufferDescription.SwapChainTarget ? m_SwapChainImages : m_ColorImages;
+    m_SwapChainImageViews.resize(images.size());
 
-    for (size_t i = 0; i < m_SwapChainImages.size(); i++) {
+    for (size_t i = 0; i < images.size(); i++) {
         VkImageViewCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        createInfo.image = m_SwapChainImages[i];
+        createInfo.image = images[i];
 
         createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
         createInfo.format = m_SwapChainImageFormat;
@@ -118,7 +229,7 @@ void Framebuffer::CreateRenderPass() {
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = m_FramebufferDescription.SwapChainTarget ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
     std::vector<VkAttachmentReference> colorAttachmentRefs;
     for(int i = 0; i < m_FramebufferDescription.Attachments.Attachments.size(); i++) {
@@ -183,8 +294,17 @@ void Framebuffer::CleanupSwapChain() {
         vkDestroyImageView(device, m_SwapChainImageViews[i], nullptr);
     }
 
-    vkDestroySwapchainKHR(device, m_Swapchain, nullptr);
-    vkDestroyRenderPass(device, m_RenderPass, nullptr);
+    m_Framebuffers.clear();
+    m_SwapChainImageViews.clear();
+
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    for (size_t i = 0; i < m_ColorImages.size(); i++) {
+        vkDestroyImage(device, m_ColorImages[i], nullptr);
+        allocator.Free(m_ColorImageAllocations[i]);
+    }
+
+    m_ColorImages.clear();
+    m_ColorImageAllocations.clear();
 }
 
 VkSurfaceFormatKHR Framebuffer::ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
@@ -198,15 +318,48 @@ VkSurfaceFormatKHR Framebuffer::ChooseSwapSurfaceFormat(const std::vector<VkSurf
 }
 
 VkPresentModeKHR Framebuffer::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-    //for (const auto& availablePresentMode : availablePresentModes) {
-    //    if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-    //        return availablePresentMode;
-    //    }
-    //}
+    //Uncapped modes fall back to each other before giving up on leaving vsync
+    std::vector<VkPresentModeKHR> preferredModes;
+    switch (m_FramebufferDescription.PreferredPresentMode) {
+        case PresentMode::Immediate:
+            preferredModes = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR };
+            break;
+        case PresentMode::Mailbox:
+            preferredModes = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR };
+            break;
+        case PresentMode::FifoRelaxed:
+            preferredModes = { VK_PRESENT_MODE_FIFO_RELAXED_KHR };
+            break;
+        case PresentMode::Fifo:
+            break;
+    }
 
+    for (VkPresentModeKHR preferredMode : preferredModes) {
+        if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preferredMode) != availablePresentModes.end())
+            return preferredMode;
+    }
+
+    //The only mode every surface has to support
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+uint32_t Framebuffer::ChooseSwapImageCount(const VkSurfaceCapabilitiesKHR& capabilities, VkPresentModeKHR presentMode) {
+    uint32_t imageCount = m_FramebufferDescription.SwapChainImageCount;
+    if (imageCount == 0) {
+        imageCount = capabilities.minImageCount + 1;
+
+        //Mailbox only stays uncapped if there is an image to render into while one is shown and another is queued
+        if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+            imageCount = (std::max)(imageCount, 3u);
+    }
+
+    imageCount = (std::max)(imageCount, capabilities.minImageCount);
+    if (capabilities.maxImageCount > 0)
+        imageCount = (std::min)(imageCount, capabilities.maxImageCount);
+
+    return imageCount;
+}
+
 VkExtent2D Framebuffer::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
     if (capabilities.currentExtent.width != (std::numeric_limits<uint32_t>::max)()) {
         return capabilities.currentExtent;
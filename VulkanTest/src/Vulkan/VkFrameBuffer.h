@@ -5,6 +5,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include "VkMemoryAllocator.h"
+
 enum class FramebufferTextureFormat {
 	None = 0,
 
@@ -42,6 +44,14 @@ struct FramebufferTextureSpecification {
 	}
 };
 
+//What the swapchain should present with, falls back to the closest mode the surface supports
+enum class PresentMode {
+	Fifo = 0,		//Vsync, always supported
+	FifoRelaxed,	//Vsync, but a frame that missed the blank is shown right away and may tear
+	Mailbox,		//Uncapped without tearing, a newer frame replaces the one waiting to be shown
+	Immediate		//Uncapped, tears
+};
+
 struct FramebufferAttachmentSpecification {
 	FramebufferAttachmentSpecification() = default;
 	FramebufferAttachmentSpecification(std::initializer_list<FramebufferTextureSpecification> attachments)
@@ -56,6 +66,14 @@ struct FramebufferDescription {
 	uint32_t Width, Height;
 	uint32_t Samples = 1;
 
+	//Renders into the swapchain images when true, into ImageCount images owned by the framebuffer otherwise
+	bool SwapChainTarget = true;
+	uint32_t ImageCount = 2;
+
+	//Swapchain only, 0 picks minImageCount + 1 (at least 3 for mailbox), anything else is clamped to what the surface allows
+	PresentMode PreferredPresentMode = PresentMode::Fifo;
+	uint32_t SwapChainImageCount = 0;
+
 	VkSampleCountFlagBits GetVkSampleCount() const {
 		switch (Samples) {
 			case 1: return VK_SAMPLE_COUNT_1_BIT;
@@ -79,17 +97,33 @@ public:
 	Framebuffer(const FramebufferDescription& frameBufferSpecification);
 	~Framebuffer();
 
+	//Doesn't wait for the GPU, the old swapchain is handed to the new one so presentation isn't interrupted and
+	//everything replaced goes to the device's deletion queue. The render pass is only replaced if the format changed.
 	void ReCreate();
 
+	//Take effect on the next ReCreate
+	void SetPresentMode(PresentMode presentMode) { m_FramebufferDescription.PreferredPresentMode = presentMode; }
+	void SetSwapChainImageCount(uint32_t imageCount) { m_FramebufferDescription.SwapChainImageCount = imageCount; }
+
+	//The mode that was actually picked, which can differ from the preferred one
+	VkPresentModeKHR GetPresentMode() const { return m_PresentMode; }
+
 	VkSwapchainKHR GetSwapchain() const { return m_Swapchain; }
 	VkRenderPass GetRenderPass() const { return m_RenderPass; }
 
 	VkFramebuffer GetFramebuffer(uint32_t index) const { return m_Framebuffers[index]; }
 
+	//Offscreen images are left in TRANSFER_SRC_OPTIMAL at the end of the render pass so they can be read back
+	bool IsSwapChainTarget() const { return m_FramebufferDescription.SwapChainTarget; }
+	uint32_t GetImageCount() const { return static_cast<uint32_t>(m_Framebuffers.size()); }
+	VkImage GetImage(uint32_t index) const { return IsSwapChainTarget() ? m_SwapChainImages[index] : m_ColorImages[index]; }
+
 	const VkExtent2D& GetExtent() const { return m_SwapChainExtent; }
 	const VkFormat& GetColorFormat() const { return m_SwapChainImageFormat; }
+	VkSampleCountFlagBits GetSampleCount() const { return m_FramebufferDescription.GetVkSampleCount(); }
 private:
-	void CreateSwapChain();
+	void CreateSwapChain(VkSwapchainKHR oldSwapchain);
+	void CreateColorImages();
 	void CreateImageViews();
 
 	void CreateRenderPass();
@@ -101,14 +135,19 @@ private:
 	VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 	VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 	VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
+	uint32_t ChooseSwapImageCount(const VkSurfaceCapabilitiesKHR& capabilities, VkPresentModeKHR presentMode);
 private:
 	FramebufferDescription m_FramebufferDescription;
 
-	VkSwapchainKHR m_Swapchain;
+	VkSwapchainKHR m_Swapchain = VK_NULL_HANDLE;
+	VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
 	std::vector<VkImage> m_SwapChainImages;
 	VkFormat m_SwapChainImageFormat;
 	VkExtent2D m_SwapChainExtent;
 	std::vector<VkImageView> m_SwapChainImageViews;
+
+	std::vector<VkImage> m_ColorImages;
+	std::vector<MemoryAllocation> m_ColorImageAllocations;
 	
 	VkRenderPass m_RenderPass;
 
@@ -0,0 +1,92 @@
+#include "VkFramePacer.h"
+
+#include <algorithm>
+
+void FramePacer::Init(uint32_t frameCount) {
+    m_Frames.resize(frameCount);
+    Reset();
+}
+
+void FramePacer::Reset() {
+    for (auto& frame : m_Frames)
+        frame = FrameRecord{};
+
+    m_HasSubmitted = false;
+    m_FrameStart = m_LastCompletion = m_PredictedGpuIdle = Clock::now();
+}
+
+void FramePacer::BeginFrame(VkDevice device, const std::vector<VkFence>& fences) {
+    m_Timing.PacingDelay = 0.0;
+    m_Timing.CpuWait = 0.0;
+
+    Clock::time_point start = Clock::now();
+
+    if (m_Mode == FramePacing::LowLatency && m_HasSubmitted && m_Frames[m_LastSubmittedFrame].InFlight) {
+        //Start early enough that the CPU work is done right as the GPU finishes the last frame
+        Clock::time_point wakeTime = m_PredictedGpuIdle - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(m_Timing.CpuFrameTime));
+
+        if (wakeTime > start) {
+            uint64_t timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeTime - start).count();
+
+            VkFence fence = fences[m_LastSubmittedFrame];
+            if (vkWaitForFences(device, 1, &fence, VK_TRUE, timeout) == VK_SUCCESS)
+                OnFrameComplete(m_LastSubmittedFrame, Clock::now());
+        }
+    }
+
+    m_FrameStart = Clock::now();
+    m_Timing.PacingDelay = ToMilliseconds(m_FrameStart - start);
+}
+
+void FramePacer::WaitForFrame(VkDevice device, VkFence fence, uint32_t frame) {
+    Clock::time_point start = Clock::now();
+
+    //Only a wait that actually blocked tells us when the GPU finished
+    if (vkGetFenceStatus(device, fence) == VK_SUCCESS) {
+        m_Frames[frame].InFlight = false;
+        return;
+    }
+
+    vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+    Clock::time_point end = Clock::now();
+    m_Timing.CpuWait += ToMilliseconds(end - start);
+
+    OnFrameComplete(frame, end);
+}
+
+void FramePacer::OnSubmit(uint32_t frame) {
+    Clock::time_point now = Clock::now();
+
+    m_Timing.CpuFrameTime += (ToMilliseconds(now - m_FrameStart) - m_Timing.CpuFrameTime) * SMOOTHING;
+
+    //The GPU was idle if it was expected to run out of work before this submission arrived
+    m_Timing.GpuIdle = (std::max)(0.0, ToMilliseconds(now - m_PredictedGpuIdle));
+
+    Clock::time_point gpuStart = (std::max)(now, m_PredictedGpuIdle);
+    m_PredictedGpuIdle = gpuStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(m_Timing.GpuFrameTime));
+
+    m_Frames[frame].SubmitTime = now;
+    m_Frames[frame].InFlight = true;
+    m_LastSubmittedFrame = frame;
+    m_HasSubmitted = true;
+}
+
+void FramePacer::OnFrameComplete(uint32_t frame, Clock::time_point completeTime) {
+    FrameRecord& record = m_Frames[frame];
+    if (!record.InFlight)
+        return;
+
+    record.InFlight = false;
+
+    //The GPU started on this frame once it was submitted and the frame before it was done
+    Clock::time_point gpuStart = (std::max)(record.SubmitTime, m_LastCompletion);
+    if (completeTime > gpuStart)
+        m_Timing.GpuFrameTime += (ToMilliseconds(completeTime - gpuStart) - m_Timing.GpuFrameTime) * SMOOTHING;
+
+    m_LastCompletion = completeTime;
+
+    //Seeing the last submitted frame finish means the GPU has nothing left to do
+    if (frame == m_LastSubmittedFrame)
+        m_PredictedGpuIdle = completeTime;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <vector>
+
+enum class FramePacing {
+	Throughput,	//Start the next frame as soon as a frame slot is free, keeps the GPU busiest
+	LowLatency	//Hold the frame back until just before the GPU runs out of work, so input is sampled as late as possible
+};
+
+//All times in milliseconds
+struct FrameTiming {
+	double PacingDelay = 0.0;	//Held back on purpose before the frame started, LowLatency only
+	double CpuWait = 0.0;		//Blocked on the frame slot's fence
+	double GpuIdle = 0.0;		//Estimated time the GPU had nothing to do before this frame was submitted
+
+	double CpuFrameTime = 0.0;	//Smoothed time from frame start to submit
+	double GpuFrameTime = 0.0;	//Smoothed estimate of how long the GPU takes per frame
+};
+
+//Decides when the CPU starts a frame and measures how long it waits on the GPU and the other way round.
+//GPU times are estimated from when fences are seen to signal, so they are only as good as those observations.
+class FramePacer {
+public:
+	void Init(uint32_t frameCount);
+	void Reset();
+
+	void SetMode(FramePacing mode) { m_Mode = mode; }
+	FramePacing GetMode() const { return m_Mode; }
+
+	//Top of the frame, before input is polled. In LowLatency mode this waits on the last submitted frame,
+	//but no longer than the point the CPU has to start to have the next frame ready when the GPU gets idle.
+	void BeginFrame(VkDevice device, const std::vector<VkFence>& fences);
+
+	//Wraps the wait on the fence of the frame slot about to be reused
+	void WaitForFrame(VkDevice device, VkFence fence, uint32_t frame);
+
+	void OnSubmit(uint32_t frame);
+
+	const FrameTiming& GetTiming() const { return m_Timing; }
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void OnFrameComplete(uint32_t frame, Clock::time_point completeTime);
+	static double ToMilliseconds(Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+private:
+	FramePacing m_Mode = FramePacing::Throughput;
+	FrameTiming m_Timing;
+
+	struct FrameRecord {
+		Clock::time_point SubmitTime;
+		bool InFlight = false;
+	};
+	std::vector<FrameRecord> m_Frames;
+
+	uint32_t m_LastSubmittedFrame = 0;
+	bool m_HasSubmitted = false;
+
+	Clock::time_point m_FrameStart;
+	Clock::time_point m_LastCompletion;
+
+	//When the GPU is expected to run out of submitted work
+	Clock::time_point m_PredictedGpuIdle;
+
+	//Weight of the newest sample in the smoothed frame times
+	static constexpr double SMOOTHING = 0.1;
+};
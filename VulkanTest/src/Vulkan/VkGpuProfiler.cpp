@@ -0,0 +1,221 @@
+#include "VkGpuProfiler.h"
+
+#include "VkDevice.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+void GpuProfiler::Init(uint32_t frameCount, uint32_t maxScopes) {
+    m_Device = Device::Get().GetDevice();
+    VkPhysicalDevice physicalDevice = Device::Get().GetPhysicalDevice();
+    m_MaxScopes = maxScopes;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_TimestampPeriod = properties.limits.timestampPeriod;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    uint32_t validBits = queueFamilies[Device::Get().GetQueueFamilyIndices().GraphicsFamily.value()].timestampValidBits;
+    m_Supported = validBits > 0;
+    if (!m_Supported) {
+        std::cout << "gpu profiler: the graphics queue doesn't support timestamps, profiling is disabled" << std::endl;
+        return;
+    }
+
+    m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    m_Frames.resize(frameCount);
+    m_Results.resize(m_MaxScopes * 2);
+
+    for (auto& frameQueries : m_Frames) {
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = m_MaxScopes * 2;
+
+        if (vkCreateQueryPool(m_Device, &poolInfo, nullptr, &frameQueries.Pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+
+        frameQueries.Scopes.reserve(m_MaxScopes);
+    }
+}
+
+void GpuProfiler::Shutdown() {
+    for (auto& frameQueries : m_Frames)
+        vkDestroyQueryPool(m_Device, frameQueries.Pool, nullptr);
+
+    m_Frames.clear();
+
+    if (m_CsvFile.is_open())
+        m_CsvFile.close();
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame) {
+    if (!m_Supported)
+        return;
+
+    m_CurrentFrame = frame;
+    FrameQueries& frameQueries = m_Frames[frame];
+
+    if (frameQueries.Pending)
+        Collect(frameQueries);
+
+    frameQueries.Scopes.clear();
+    vkCmdResetQueryPool(commandBuffer, frameQueries.Pool, 0, m_MaxScopes * 2);
+}
+
+uint32_t GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const std::string& name) {
+    if (!m_Supported)
+        return NO_SCOPE;
+
+    FrameQueries& frameQueries = m_Frames[m_CurrentFrame];
+    if (frameQueries.Scopes.size() >= m_MaxScopes)
+        return NO_SCOPE;
+
+    uint32_t scope = static_cast<uint32_t>(frameQueries.Scopes.size());
+    frameQueries.Scopes.push_back(GetHistory(name));
+    frameQueries.Pending = true;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frameQueries.Pool, scope * 2);
+    return scope;
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+    if (scope == NO_SCOPE)
+        return;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_Frames[m_CurrentFrame].Pool, scope * 2 + 1);
+}
+
+std::vector<GpuScopeStats> GpuProfiler::GetStats() const {
+    std::vector<GpuScopeStats> stats;
+    stats.reserve(m_Histories.size());
+
+    for (const auto& history : m_Histories)
+        stats.push_back(BuildStats(history));
+
+    return stats;
+}
+
+bool GpuProfiler::GetScopeStats(const std::string& name, GpuScopeStats& stats) const {
+    auto it = m_HistoryIndices.find(name);
+    if (it == m_HistoryIndices.end())
+        return false;
+
+    stats = BuildStats(m_Histories[it->second]);
+    return true;
+}
+
+GpuScopeStats GpuProfiler::BuildStats(const ScopeHistory& history) {
+    GpuScopeStats stats{};
+    stats.Name = history.Name;
+    stats.SampleCount = history.SampleCount;
+
+    if (history.Samples.empty())
+        return stats;
+
+    stats.Last = history.Samples[(history.Next + history.Samples.size() - 1) % history.Samples.size()];
+    stats.Min = *std::min_element(history.Samples.begin(), history.Samples.end());
+    stats.Max = *std::max_element(history.Samples.begin(), history.Samples.end());
+
+    for (double sample : history.Samples)
+        stats.Avg += sample;
+    stats.Avg /= history.Samples.size();
+
+    return stats;
+}
+
+void GpuProfiler::PrintStats() const {
+    std::cout << "gpu profiler: last / min / avg / max ms over " << SAMPLE_WINDOW << " frames" << std::endl;
+
+    for (const auto& scopeStats : GetStats()) {
+        std::cout << "    " << std::left << std::setw(24) << scopeStats.Name << std::right << std::fixed << std::setprecision(3)
+            << scopeStats.Last << " / " << scopeStats.Min << " / " << scopeStats.Avg << " / " << scopeStats.Max << std::endl;
+    }
+
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+void GpuProfiler::SetReportInterval(uint32_t interval, const std::filesystem::path& csvPath) {
+    m_ReportInterval = interval;
+
+    if (m_CsvFile.is_open())
+        m_CsvFile.close();
+
+    if (csvPath.empty())
+        return;
+
+    m_CsvFile.open(csvPath, std::ios::trunc);
+    if (!m_CsvFile.is_open()) {
+        std::cerr << "gpu profiler: failed to open " << csvPath << std::endl;
+        return;
+    }
+
+    m_CsvFile << "frame,scope,last_ms,min_ms,avg_ms,max_ms" << std::endl;
+}
+
+void GpuProfiler::Collect(FrameQueries& frameQueries) {
+    frameQueries.Pending = false;
+
+    const uint32_t queryCount = static_cast<uint32_t>(frameQueries.Scopes.size()) * 2;
+    if (queryCount == 0)
+        return;
+
+    //The frame's fence has signaled, so anything not available now was never written and is skipped
+    VkResult result = vkGetQueryPoolResults(m_Device, frameQueries.Pool, 0, queryCount, queryCount * sizeof(uint64_t),
+        m_Results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+        return;
+
+    for (uint32_t scope = 0; scope < frameQueries.Scopes.size(); scope++) {
+        uint64_t begin = m_Results[scope * 2] & m_TimestampMask;
+        uint64_t end = m_Results[scope * 2 + 1] & m_TimestampMask;
+        uint64_t ticks = (end - begin) & m_TimestampMask;
+
+        ScopeHistory& history = m_Histories[frameQueries.Scopes[scope]];
+        double time = ticks * m_TimestampPeriod / 1000000.0;
+
+        if (history.Samples.size() < SAMPLE_WINDOW)
+            history.Samples.push_back(time);
+        else
+            history.Samples[history.Next] = time;
+
+        history.Next = (history.Next + 1) % SAMPLE_WINDOW;
+        history.SampleCount++;
+    }
+
+    m_CollectedFrames++;
+    if (m_ReportInterval > 0 && m_CollectedFrames % m_ReportInterval == 0)
+        Report();
+}
+
+void GpuProfiler::Report() {
+    if (!m_CsvFile.is_open()) {
+        PrintStats();
+        return;
+    }
+
+    for (const auto& scopeStats : GetStats()) {
+        m_CsvFile << m_CollectedFrames << "," << scopeStats.Name << "," << scopeStats.Last << ","
+            << scopeStats.Min << "," << scopeStats.Avg << "," << scopeStats.Max << "\n";
+    }
+    m_CsvFile.flush();
+}
+
+uint32_t GpuProfiler::GetHistory(const std::string& name) {
+    auto it = m_HistoryIndices.find(name);
+    if (it != m_HistoryIndices.end())
+        return it->second;
+
+    uint32_t index = static_cast<uint32_t>(m_Histories.size());
+    m_Histories.push_back({ name });
+    m_HistoryIndices.emplace(name, index);
+
+    return index;
+}
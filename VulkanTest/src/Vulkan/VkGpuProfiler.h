@@ -0,0 +1,91 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+
+//All times in milliseconds, over the last SAMPLE_WINDOW frames the scope was recorded in
+struct GpuScopeStats {
+	std::string Name;
+
+	double Last = 0.0;
+	double Min = 0.0;
+	double Avg = 0.0;
+	double Max = 0.0;
+
+	uint64_t SampleCount = 0;
+};
+
+//Measures GPU time of named command buffer regions with timestamp queries, one query pool per frame slot.
+//Results are read when the slot comes around again, after its fence was waited on, so reading never stalls.
+class GpuProfiler {
+public:
+	void Init(uint32_t frameCount, uint32_t maxScopes = DEFAULT_MAX_SCOPES);
+	void Shutdown();
+
+	//Call at the start of the slot's command buffer, after its fence was waited on. Collects what the frame
+	//that used the slot before recorded and resets the pool.
+	void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+	//Scopes may nest, ones past maxScopes in a frame are silently dropped
+	uint32_t BeginScope(VkCommandBuffer commandBuffer, const std::string& name);
+	void EndScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+	//Timestamps need a queue family with timestampValidBits, without one every call does nothing
+	bool IsSupported() const { return m_Supported; }
+
+	std::vector<GpuScopeStats> GetStats() const;
+	//False if no scope with that name was ever recorded
+	bool GetScopeStats(const std::string& name, GpuScopeStats& stats) const;
+	void PrintStats() const;
+
+	//Every interval collected frames the stats are printed, or appended to csvPath as CSV when one is given. 0 turns it off.
+	void SetReportInterval(uint32_t interval, const std::filesystem::path& csvPath = {});
+public:
+	static const uint32_t DEFAULT_MAX_SCOPES = 64;
+	static const uint32_t SAMPLE_WINDOW = 120;
+	static const uint32_t NO_SCOPE = ~0u;
+private:
+	struct ScopeHistory {
+		std::string Name;
+		std::vector<double> Samples;
+		uint32_t Next = 0;
+		uint64_t SampleCount = 0;
+	};
+
+	struct FrameQueries {
+		VkQueryPool Pool = VK_NULL_HANDLE;
+
+		//History index of every scope recorded in the frame, the scope's queries are 2 * i and 2 * i + 1
+		std::vector<uint32_t> Scopes;
+		bool Pending = false;
+	};
+
+	static GpuScopeStats BuildStats(const ScopeHistory& history);
+
+	void Collect(FrameQueries& frameQueries);
+	void Report();
+	uint32_t GetHistory(const std::string& name);
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	bool m_Supported = false;
+
+	double m_TimestampPeriod = 1.0;	//Nanoseconds per tick
+	uint64_t m_TimestampMask = ~0ull;
+	uint32_t m_MaxScopes = 0;
+
+	std::vector<FrameQueries> m_Frames;
+	uint32_t m_CurrentFrame = 0;
+
+	std::vector<ScopeHistory> m_Histories;
+	std::unordered_map<std::string, uint32_t> m_HistoryIndices;
+	std::vector<uint64_t> m_Results;
+
+	uint32_t m_ReportInterval = 0;
+	uint64_t m_CollectedFrames = 0;
+	std::ofstream m_CsvFile;
+};
+
@@ -0,0 +1,311 @@
+#include "VkMemoryAllocator.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void MemoryAllocator::Init(VkDevice device, VkPhysicalDevice physicalDevice) {
+    m_Device = device;
+
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    m_NonCoherentAtomSize = deviceProperties.limits.nonCoherentAtomSize;
+    m_Pools.resize(m_MemoryProperties.memoryTypeCount * 2);
+}
+
+void MemoryAllocator::Shutdown() {
+    MemoryAllocatorStats stats = GetStats();
+    if (stats.AllocationCount > 0)
+        std::cerr << "memory allocator: " << stats.AllocationCount << " allocations (" << stats.BytesUsed << " bytes) were never freed" << std::endl;
+
+    for (auto& pool : m_Pools) {
+        for (auto& block : pool) {
+            if (block->MapCount > 0)
+                vkUnmapMemory(m_Device, block->Memory);
+            vkFreeMemory(m_Device, block->Memory, nullptr);
+        }
+        pool.clear();
+    }
+}
+
+MemoryAllocation MemoryAllocator::Allocate(const VkMemoryRequirements& memoryRequirements, VkMemoryPropertyFlags properties, MemoryResourceType resourceType, VkMemoryPropertyFlags preferredProperties) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    uint32_t memoryTypeIndex = FindMemoryType(memoryRequirements.memoryTypeBits, properties, preferredProperties);
+    uint32_t poolIndex = memoryTypeIndex * 2 + static_cast<uint32_t>(resourceType);
+    VkDeviceSize blockSize = GetBlockSize(memoryTypeIndex);
+
+    //Flushes and invalidates work on whole atoms, so non coherent allocations never share one with a neighbour
+    VkMemoryRequirements requirements = memoryRequirements;
+    VkMemoryPropertyFlags typeProperties = GetMemoryTypeProperties(memoryTypeIndex);
+    if ((typeProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+        requirements.alignment = (std::max)(requirements.alignment, m_NonCoherentAtomSize);
+        requirements.size = AlignUp(requirements.size, m_NonCoherentAtomSize);
+    }
+
+    MemoryBlock* block = nullptr;
+    VkDeviceSize offset = 0;
+
+    //Big resources get a block of their own instead of eating most of a shared one
+    if (requirements.size >= blockSize / 2) {
+        block = CreateBlock(memoryTypeIndex, poolIndex, requirements.size, true);
+        AllocateFromBlock(block, requirements.size, requirements.alignment, offset);
+    }
+    else {
+        for (auto& poolBlock : m_Pools[poolIndex]) {
+            if (!poolBlock->Dedicated && AllocateFromBlock(poolBlock.get(), requirements.size, requirements.alignment, offset)) {
+                block = poolBlock.get();
+                break;
+            }
+        }
+
+        if (block == nullptr) {
+            block = CreateBlock(memoryTypeIndex, poolIndex, blockSize, false);
+            AllocateFromBlock(block, requirements.size, requirements.alignment, offset);
+        }
+    }
+
+    MemoryAllocation allocation{};
+    allocation.Memory = block->Memory;
+    allocation.Offset = offset;
+    allocation.Size = requirements.size;
+    allocation.MemoryTypeIndex = memoryTypeIndex;
+    allocation.Block = block;
+
+    return allocation;
+}
+
+void MemoryAllocator::Free(MemoryAllocation& allocation) {
+    if (!allocation.IsValid())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MemoryBlock* block = allocation.Block;
+    block->Used -= allocation.Size;
+    block->AllocationCount--;
+
+    //Insert the range back and merge it with the free ranges directly before and after it
+    auto& ranges = block->FreeRanges;
+    auto it = std::lower_bound(ranges.begin(), ranges.end(), allocation.Offset,
+        [](const MemoryBlock::FreeRange& range, VkDeviceSize offset) { return range.Offset < offset; });
+    it = ranges.insert(it, { allocation.Offset, allocation.Size });
+
+    auto next = it + 1;
+    if (next != ranges.end() && it->Offset + it->Size == next->Offset) {
+        it->Size += next->Size;
+        ranges.erase(next);
+    }
+    if (it != ranges.begin()) {
+        auto prev = it - 1;
+        if (prev->Offset + prev->Size == it->Offset) {
+            prev->Size += it->Size;
+            ranges.erase(it);
+        }
+    }
+
+    allocation = MemoryAllocation{};
+
+    //Keep one empty block around per pool so a create/destroy loop doesn't hit vkAllocateMemory every time
+    if (block->AllocationCount == 0) {
+        auto& pool = m_Pools[block->PoolIndex];
+        bool hasOtherBlock = std::any_of(pool.begin(), pool.end(), [block](const std::unique_ptr<MemoryBlock>& other) {
+            return other.get() != block && !other->Dedicated;
+        });
+
+        if (block->Dedicated || hasOtherBlock)
+            DestroyBlock(block);
+    }
+}
+
+void* MemoryAllocator::Map(const MemoryAllocation& allocation) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MemoryBlock* block = allocation.Block;
+    if (block->MapCount == 0) {
+        if (vkMapMemory(m_Device, block->Memory, 0, VK_WHOLE_SIZE, 0, &block->MappedData) != VK_SUCCESS) {
+            throw std::runtime_error("failed to map device memory!");
+        }
+    }
+    block->MapCount++;
+
+    return static_cast<char*>(block->MappedData) + allocation.Offset;
+}
+
+void MemoryAllocator::Unmap(const MemoryAllocation& allocation) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MemoryBlock* block = allocation.Block;
+    if (--block->MapCount == 0) {
+        vkUnmapMemory(m_Device, block->Memory);
+        block->MappedData = nullptr;
+    }
+}
+
+void MemoryAllocator::Flush(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) {
+    if (IsCoherent(allocation))
+        return;
+
+    VkMappedMemoryRange range = GetMappedRange(allocation, offset, size);
+    vkFlushMappedMemoryRanges(m_Device, 1, &range);
+}
+
+void MemoryAllocator::Invalidate(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) {
+    if (IsCoherent(allocation))
+        return;
+
+    VkMappedMemoryRange range = GetMappedRange(allocation, offset, size);
+    vkInvalidateMappedMemoryRanges(m_Device, 1, &range);
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties) const {
+    if (preferredProperties != 0) {
+        VkMemoryPropertyFlags wanted = properties | preferredProperties;
+        for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & wanted) == wanted) {
+                return i;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+MemoryAllocatorStats MemoryAllocator::GetStats() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    MemoryAllocatorStats stats{};
+    VkDeviceSize totalFree = 0;
+
+    for (auto& pool : m_Pools) {
+        for (auto& block : pool) {
+            stats.BytesReserved += block->Size;
+            stats.BytesUsed += block->Used;
+            stats.BlockCount++;
+            stats.AllocationCount += block->AllocationCount;
+
+            for (const auto& range : block->FreeRanges) {
+                totalFree += range.Size;
+                stats.LargestFreeRange = (std::max)(stats.LargestFreeRange, range.Size);
+            }
+        }
+    }
+
+    if (totalFree > 0)
+        stats.Fragmentation = 1.0f - static_cast<float>(stats.LargestFreeRange) / static_cast<float>(totalFree);
+
+    return stats;
+}
+
+void MemoryAllocator::PrintStats() {
+    MemoryAllocatorStats stats = GetStats();
+
+    std::cout << "memory allocator: " << stats.BlockCount << " blocks, "
+        << stats.BytesReserved / 1024 << " KiB reserved, "
+        << stats.BytesUsed / 1024 << " KiB used by " << stats.AllocationCount << " allocations, "
+        << "fragmentation " << stats.Fragmentation * 100.0f << "%" << std::endl;
+}
+
+MemoryBlock* MemoryAllocator::CreateBlock(uint32_t memoryTypeIndex, uint32_t poolIndex, VkDeviceSize size, bool dedicated) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    auto block = std::make_unique<MemoryBlock>();
+    if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &block->Memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory block!");
+    }
+
+    block->MemoryTypeIndex = memoryTypeIndex;
+    block->PoolIndex = poolIndex;
+    block->Size = size;
+    block->Dedicated = dedicated;
+    block->FreeRanges.push_back({ 0, size });
+
+    m_Pools[poolIndex].push_back(std::move(block));
+    return m_Pools[poolIndex].back().get();
+}
+
+void MemoryAllocator::DestroyBlock(MemoryBlock* block) {
+    if (block->MapCount > 0)
+        vkUnmapMemory(m_Device, block->Memory);
+    vkFreeMemory(m_Device, block->Memory, nullptr);
+
+    auto& pool = m_Pools[block->PoolIndex];
+    pool.erase(std::remove_if(pool.begin(), pool.end(), [block](const std::unique_ptr<MemoryBlock>& other) {
+        return other.get() == block;
+    }), pool.end());
+}
+
+bool MemoryAllocator::AllocateFromBlock(MemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset) {
+    //Best fit, the range that leaves the smallest remainder wins
+    auto best = block->FreeRanges.end();
+    VkDeviceSize bestWaste = ~0ull;
+
+    for (auto it = block->FreeRanges.begin(); it != block->FreeRanges.end(); it++) {
+        VkDeviceSize alignedOffset = AlignUp(it->Offset, alignment);
+        VkDeviceSize padding = alignedOffset - it->Offset;
+        if (padding + size > it->Size)
+            continue;
+
+        VkDeviceSize waste = it->Size - size - padding;
+        if (waste < bestWaste) {
+            best = it;
+            bestWaste = waste;
+        }
+    }
+
+    if (best == block->FreeRanges.end())
+        return false;
+
+    VkDeviceSize rangeOffset = best->Offset;
+    VkDeviceSize rangeEnd = best->Offset + best->Size;
+    VkDeviceSize alignedOffset = AlignUp(rangeOffset, alignment);
+
+    //The alignment padding stays free so it can be merged back once its neighbour is released
+    best = block->FreeRanges.erase(best);
+    if (alignedOffset + size < rangeEnd)
+        best = block->FreeRanges.insert(best, { alignedOffset + size, rangeEnd - alignedOffset - size });
+    if (alignedOffset > rangeOffset)
+        block->FreeRanges.insert(best, { rangeOffset, alignedOffset - rangeOffset });
+
+    block->Used += size;
+    block->AllocationCount++;
+
+    outOffset = alignedOffset;
+    return true;
+}
+
+VkMappedMemoryRange MemoryAllocator::GetMappedRange(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const {
+    VkDeviceSize begin = (allocation.Offset + offset) / m_NonCoherentAtomSize * m_NonCoherentAtomSize;
+    VkDeviceSize end = (std::min)(AlignUp(allocation.Offset + offset + size, m_NonCoherentAtomSize), allocation.Block->Size);
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.Memory;
+    range.offset = begin;
+    range.size = end - begin;
+
+    return range;
+}
+
+VkDeviceSize MemoryAllocator::GetBlockSize(uint32_t memoryTypeIndex) const {
+    //Small heaps (e.g. the 256MiB host visible BAR) get smaller blocks so one block can't take the whole heap
+    uint32_t heapIndex = m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[heapIndex].size;
+
+    return (std::min)(DEFAULT_BLOCK_SIZE, heapSize / 8);
+}
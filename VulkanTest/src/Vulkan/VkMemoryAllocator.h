@@ -0,0 +1,103 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+//One VkDeviceMemory allocation that buffers and images are placed into
+struct MemoryBlock {
+	struct FreeRange {
+		VkDeviceSize Offset;
+		VkDeviceSize Size;
+	};
+
+	VkDeviceMemory Memory = VK_NULL_HANDLE;
+	uint32_t MemoryTypeIndex = 0;
+	uint32_t PoolIndex = 0;
+
+	VkDeviceSize Size = 0;
+	VkDeviceSize Used = 0;
+	uint32_t AllocationCount = 0;
+
+	//Sorted by offset so neighbouring ranges can be merged when an allocation is freed
+	std::vector<FreeRange> FreeRanges;
+
+	void* MappedData = nullptr;
+	uint32_t MapCount = 0;
+
+	bool Dedicated = false;
+};
+
+//A range inside one of the allocator's VkDeviceMemory blocks
+struct MemoryAllocation {
+	VkDeviceMemory Memory = VK_NULL_HANDLE;
+	VkDeviceSize Offset = 0;
+	VkDeviceSize Size = 0;
+
+	uint32_t MemoryTypeIndex = 0;
+	MemoryBlock* Block = nullptr;
+
+	bool IsValid() const { return Memory != VK_NULL_HANDLE; }
+};
+
+struct MemoryAllocatorStats {
+	VkDeviceSize BytesReserved = 0;
+	VkDeviceSize BytesUsed = 0;
+	VkDeviceSize LargestFreeRange = 0;
+
+	uint32_t BlockCount = 0;
+	uint32_t AllocationCount = 0;
+
+	//0 when all free space is one contiguous range, approaching 1 the more it is split up
+	float Fragmentation = 0.0f;
+};
+
+enum class MemoryResourceType {
+	Linear,		//Buffers and linear images
+	Optimal		//Optimal tiling images, kept in separate blocks so bufferImageGranularity never applies
+};
+
+//Sub-allocates buffers and images out of large VkDeviceMemory blocks, one set of blocks per memory type
+class MemoryAllocator {
+public:
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice);
+	void Shutdown();
+
+	//preferredProperties are used when a memory type with them exists, properties are always required
+	MemoryAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryResourceType resourceType = MemoryResourceType::Linear, VkMemoryPropertyFlags preferredProperties = 0);
+	void Free(MemoryAllocation& allocation);
+
+	//Maps the whole block the allocation lives in, the block stays mapped until every Map has been matched with an Unmap
+	void* Map(const MemoryAllocation& allocation);
+	void Unmap(const MemoryAllocation& allocation);
+
+	//Only do work on non coherent memory types, ranges are relative to the allocation and widened to nonCoherentAtomSize
+	void Flush(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size);
+	void Invalidate(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size);
+	bool IsCoherent(const MemoryAllocation& allocation) const { return GetMemoryTypeProperties(allocation.MemoryTypeIndex) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT; }
+
+	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferredProperties = 0) const;
+	VkMemoryPropertyFlags GetMemoryTypeProperties(uint32_t memoryTypeIndex) const { return m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags; }
+
+	MemoryAllocatorStats GetStats();
+	void PrintStats();
+public:
+	static const VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+private:
+	MemoryBlock* CreateBlock(uint32_t memoryTypeIndex, uint32_t poolIndex, VkDeviceSize size, bool dedicated);
+	void DestroyBlock(MemoryBlock* block);
+
+	bool AllocateFromBlock(MemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset);
+	VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+	VkMappedMemoryRange GetMappedRange(const MemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+	VkDeviceSize m_NonCoherentAtomSize = 1;
+
+	//Indexed by memoryTypeIndex * 2 + MemoryResourceType
+	std::vector<std::vector<std::unique_ptr<MemoryBlock>>> m_Pools;
+
+	std::mutex m_Mutex;
+};
@@ -1,27 +1,48 @@
 #include "VkPipeline.h"
 
 #include <fstream>
+#include <chrono>
+#include <algorithm>
 
 #include "VkDevice.h"
 #include "Renderer/RenderCommand.h"
+#include "Core/Instrumentor.h"
 
 
-Pipeline::Pipeline(PipelineDescription pipelineDescription) 
-    : m_PipelineDescription(pipelineDescription) {
-	CreatePipeline();
+Pipeline::Pipeline(PipelineDescription pipelineDescription, bool deferCompile)
+    : m_PipelineDescription(pipelineDescription), m_CompiledFuture(m_Compiled.get_future().share()) {
+    if (!deferCompile)
+        Compile();
 }
 
 Pipeline::~Pipeline() {
+    //The last reference can go away while frames in flight still use the pipeline, e.g. on library eviction
     VkDevice device = Device::Get().GetDevice();
+    VkPipeline pipeline = m_Pipeline;
+    VkPipelineLayout pipelineLayout = m_PipelineLayout;
 
-	vkDestroyPipeline(device, m_Pipeline, nullptr);
-	vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+    Device::Get().GetDeletionQueue().Push([device, pipeline, pipelineLayout]() {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+    });
+}
+
+void Pipeline::Compile() {
+    try {
+        CreatePipeline();
+    }
+    catch (...) {
+        m_Failed.store(true, std::memory_order_release);
+        m_Compiled.set_exception(std::current_exception());
+        throw;
+    }
+
+    m_Ready.store(true, std::memory_order_release);
+    m_Compiled.set_value();
 }
 
 void Pipeline::Bind(const VkCommandBuffer commandBuffer) {
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
-
-    m_PipelineDescription.VertexBuffer->Bind(commandBuffer);
 }
 
 void Pipeline::BeginRenderPass(const VkCommandBuffer commandBuffer, uint32_t imageIndex) {
@@ -40,46 +61,97 @@ void Pipeline::BeginRenderPass(const VkCommandBuffer commandBuffer, uint32_t ima
     vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
 
+void Pipeline::ValidatePushConstants(uint32_t offset, uint32_t size, VkShaderStageFlags stages) const {
+    if (offset % 4 != 0 || size % 4 != 0 || size == 0) {
+        throw std::runtime_error("push constants must be a non zero multiple of 4 bytes at a multiple of 4!");
+    }
+
+    //Ranges are multiples of 4 bytes, so checking every fourth byte covers all of them
+    for (uint32_t byte = offset; byte < offset + size; byte += 4) {
+        VkShaderStageFlags covering = 0;
+        for (const auto& range : m_PipelineDescription.PushConstantRanges) {
+            if (range.Offset <= byte && byte < range.Offset + range.Size)
+                covering |= range.Stages;
+        }
+
+        if (covering != stages) {
+            throw std::runtime_error("push constants aren't covered by ranges of exactly the pushed stages!");
+        }
+    }
+}
+
 void Pipeline::RecreateSwapchain() {
+    const bool dynamicViewport = m_PipelineDescription.HasDynamicViewport();
+
+    const Framebuffer& framebuffer = *m_PipelineDescription.Framebuffer;
+    const bool sameExtent = m_Extent.width == framebuffer.GetExtent().width && m_Extent.height == framebuffer.GetExtent().height;
 
+    if (!IsReady() || (framebuffer.GetRenderPass() == m_RenderPass && (dynamicViewport || sameExtent)))
+        return;
+
+    //Frames in flight may still be drawing with the old pipeline
+    VkDevice device = Device::Get().GetDevice();
+    VkPipeline oldPipeline = m_Pipeline;
+    VkPipelineLayout oldPipelineLayout = m_PipelineLayout;
+    Device::Get().GetDeletionQueue().Push([device, oldPipeline, oldPipelineLayout]() {
+        vkDestroyPipeline(device, oldPipeline, nullptr);
+        vkDestroyPipelineLayout(device, oldPipelineLayout, nullptr);
+    });
+
+    CreatePipeline();
 }
 
 void Pipeline::CreatePipeline() {
+    PROFILE_FUNCTION();
+
     VkDevice device = Device::Get().GetDevice();
-    const BufferDescription& bufferDescription = m_PipelineDescription.VertexBuffer->GetDescription();
 
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages = m_PipelineDescription.Shaders->GetShaderStages();
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = bufferDescription.Layout.GetStride();
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
     std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
-    for (uint32_t i = 0; i < bufferDescription.Layout.GetElements().size(); i++) {
-        VkVertexInputAttributeDescription attributeDescription{};
-        attributeDescription.binding = 0;
-        attributeDescription.location = i;
-        attributeDescription.format = bufferDescription.Layout.GetElements()[i].GetVulkanType();
-        attributeDescription.offset = bufferDescription.Layout.GetElements()[i].Offset;
-
-        attributeDescriptions.push_back(attributeDescription);
+
+    //Locations keep counting up across bindings, matching the order the shader declares its inputs in
+    uint32_t location = 0;
+    for (uint32_t binding = 0; binding < m_PipelineDescription.VertexLayouts.size(); binding++) {
+        const BufferLayout& vertexLayout = m_PipelineDescription.VertexLayouts[binding];
+
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = binding;
+        bindingDescription.stride = vertexLayout.GetStride();
+        bindingDescription.inputRate = vertexLayout.GetInputRate();
+
+        bindingDescriptions.push_back(bindingDescription);
+
+        for (const auto& element : vertexLayout) {
+            //Matrices are fed as one attribute per column at consecutive locations
+            for (uint32_t column = 0; column < element.GetLocationCount(); column++) {
+                VkVertexInputAttributeDescription attributeDescription{};
+                attributeDescription.binding = binding;
+                attributeDescription.location = location++;
+                attributeDescription.format = element.GetVulkanType();
+                attributeDescription.offset = static_cast<uint32_t>(element.Offset + column * element.ColumnStride);
+
+                attributeDescriptions.push_back(attributeDescription);
+            }
+        }
     }
 
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
     vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.topology = m_PipelineDescription.GetVkPrimitiveTopology();
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
     VkExtent2D framebufferExtent = m_PipelineDescription.Framebuffer->GetExtent();
+    m_Extent = framebufferExtent;
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -111,9 +183,9 @@ void Pipeline::CreatePipeline() {
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.polygonMode = m_PipelineDescription.Wireframe ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.cullMode = m_PipelineDescription.GetVkCullMode();
     rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
     rasterizer.depthBiasConstantFactor = 0.0f; // Optional
@@ -129,15 +201,7 @@ void Pipeline::CreatePipeline() {
     multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
     multisampling.alphaToOneEnable = VK_FALSE; // Optional
 
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optional
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = m_PipelineDescription.GetVkColorBlendAttachment();
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -150,12 +214,38 @@ void Pipeline::CreatePipeline() {
     colorBlending.blendConstants[2] = 0.0f; // Optional
     colorBlending.blendConstants[3] = 0.0f; // Optional
 
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    for (const auto& setLayout : m_PipelineDescription.DescriptorSetLayouts)
+        setLayouts.push_back(setLayout->GetLayout());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(Device::Get().GetPhysicalDevice(), &properties);
+
+    std::vector<VkPushConstantRange> pushConstantRanges;
+    m_PushConstantSize = 0;
+    for (const auto& range : m_PipelineDescription.PushConstantRanges) {
+        if (range.Offset % 4 != 0 || range.Size % 4 != 0 || range.Size == 0) {
+            throw std::runtime_error("push constant ranges must be a non zero multiple of 4 bytes!");
+        }
+        if (range.Offset + range.Size > properties.limits.maxPushConstantsSize) {
+            throw std::runtime_error("push constant range is larger than maxPushConstantsSize!");
+        }
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = range.Stages;
+        pushConstantRange.offset = range.Offset;
+        pushConstantRange.size = range.Size;
+        pushConstantRanges.push_back(pushConstantRange);
+
+        m_PushConstantSize = (std::max)(m_PushConstantSize, range.Offset + range.Size);
+    }
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0; // Optional
-    pipelineLayoutInfo.pSetLayouts = nullptr; // Optional
-    pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-    pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
@@ -174,12 +264,30 @@ void Pipeline::CreatePipeline() {
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = m_PipelineLayout;
-    pipelineInfo.renderPass = m_PipelineDescription.Framebuffer->GetRenderPass();
+    m_RenderPass = m_PipelineDescription.Framebuffer->GetRenderPass();
+    pipelineInfo.renderPass = m_RenderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
     pipelineInfo.basePipelineIndex = -1; // Optional
 
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
+    //Tells us whether the driver found the pipeline in the cache or had to compile it
+    VkPipelineCreationFeedbackEXT creationFeedback{};
+    VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo{};
+    bool feedbackEnabled = Device::Get().IsExtensionEnabled(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+    if (feedbackEnabled) {
+        feedbackInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+        feedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+        pipelineInfo.pNext = &feedbackInfo;
+    }
+
+    PipelineCache& pipelineCache = Device::Get().GetPipelineCache();
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (vkCreateGraphicsPipelines(device, pipelineCache.GetCache(), 1, &pipelineInfo, nullptr, &m_Pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
+
+    std::chrono::duration<double, std::milli> creationTime = std::chrono::high_resolution_clock::now() - start;
+    m_CompileTime = creationTime.count();
+    pipelineCache.RecordPipeline(m_CompileTime, feedbackEnabled ? &creationFeedback : nullptr);
 }
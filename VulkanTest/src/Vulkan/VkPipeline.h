@@ -3,10 +3,14 @@
 
 #include <vector>
 #include <filesystem>
+#include <atomic>
+#include <future>
+#include <algorithm>
 
 #include "VkBuffer.h"
 #include "VkShader.h"
 #include "VkFramebuffer.h"
+#include "VkDescriptorSet.h"
 
 enum class DynamicStates {
 	Viewport,
@@ -14,16 +18,54 @@ enum class DynamicStates {
 	LineWidth
 };
 
+enum class PrimitiveTopology {
+	PointList,
+	LineList,
+	LineStrip,
+	TriangleList,
+	TriangleStrip
+};
+
+enum class CullMode {
+	None,
+	Front,
+	Back
+};
+
+enum class BlendMode {
+	None,
+	Alpha,
+	Additive
+};
+
+//Offset and size in bytes, both multiples of 4. Ranges of different stages may overlap.
+struct PushConstantRange {
+	VkShaderStageFlags Stages = VK_SHADER_STAGE_VERTEX_BIT;
+	uint32_t Offset = 0;
+	uint32_t Size = 0;
+};
+
 struct PipelineDescription {
 	std::shared_ptr<Framebuffer> Framebuffer;
 
 	std::shared_ptr<Shader> Shaders;
 
-	std::shared_ptr<Buffer> VertexBuffer;
+	PrimitiveTopology Topology = PrimitiveTopology::TriangleList;
+	CullMode Cull = CullMode::Back;
+	BlendMode Blend = BlendMode::None;
+	bool Wireframe = false;
+
+	//One vertex binding per layout in order, layouts with an instanced divisor step once per instance
+	std::vector<BufferLayout> VertexLayouts;
+
+	//Set index is the position in the list
+	std::vector<std::shared_ptr<DescriptorSetLayout>> DescriptorSetLayouts;
+
+	std::vector<PushConstantRange> PushConstantRanges;
 
 	std::vector<DynamicStates> DynamicStates;
 
-	std::vector<VkDynamicState> GetVkDynamicStates() {
+	std::vector<VkDynamicState> GetVkDynamicStates() const {
 		std::vector<VkDynamicState> dynamicStates;
 		for (auto state : DynamicStates) {
 			switch (state) {
@@ -40,19 +82,112 @@ struct PipelineDescription {
 		}
 		return dynamicStates;
 	}
+
+	//Pipelines without it have the framebuffer extent baked in
+	bool HasDynamicViewport() const {
+		return std::find(DynamicStates.begin(), DynamicStates.end(), DynamicStates::Viewport) != DynamicStates.end() &&
+			std::find(DynamicStates.begin(), DynamicStates.end(), DynamicStates::Scissor) != DynamicStates.end();
+	}
+
+	VkPrimitiveTopology GetVkPrimitiveTopology() const {
+		switch (Topology) {
+			case PrimitiveTopology::PointList:		return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+			case PrimitiveTopology::LineList:		return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+			case PrimitiveTopology::LineStrip:		return VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+			case PrimitiveTopology::TriangleList:	return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			case PrimitiveTopology::TriangleStrip:	return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+		}
+
+		throw std::runtime_error("PrimitiveTopology not supported");
+	}
+
+	VkCullModeFlags GetVkCullMode() const {
+		switch (Cull) {
+			case CullMode::None:	return VK_CULL_MODE_NONE;
+			case CullMode::Front:	return VK_CULL_MODE_FRONT_BIT;
+			case CullMode::Back:	return VK_CULL_MODE_BACK_BIT;
+		}
+
+		throw std::runtime_error("CullMode not supported");
+	}
+
+	VkPipelineColorBlendAttachmentState GetVkColorBlendAttachment() const {
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		colorBlendAttachment.blendEnable = VK_FALSE;
+		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+		switch (Blend) {
+			case BlendMode::None:
+				break;
+			case BlendMode::Alpha:
+				colorBlendAttachment.blendEnable = VK_TRUE;
+				colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+				colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+				colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+				break;
+			case BlendMode::Additive:
+				colorBlendAttachment.blendEnable = VK_TRUE;
+				colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+				colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+				colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				break;
+		}
+
+		return colorBlendAttachment;
+	}
 };
 
 class Pipeline {
 public:
-	Pipeline(PipelineDescription pipelineDescription);
+	//deferCompile leaves creating the VkPipeline to a later Compile call, which may run on any thread
+	Pipeline(PipelineDescription pipelineDescription, bool deferCompile = false);
 	~Pipeline();
 
+	void Compile();
+
+	//A pipeline can only be bound once it is ready
+	bool IsReady() const { return m_Ready.load(std::memory_order_acquire); }
+	bool HasFailed() const { return m_Failed.load(std::memory_order_acquire); }
+	void Wait() const { m_CompiledFuture.wait(); }
+
+	//Milliseconds spent in vkCreateGraphicsPipelines
+	double GetCompileTime() const { return m_CompileTime; }
+
 	void Bind(const VkCommandBuffer commandBuffer);
 
 	void BeginRenderPass(const VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
+	//Called after the framebuffer was recreated, rebuilds the pipeline only if it can't be used with the new one
 	void RecreateSwapchain();
 
+	const PipelineDescription& GetDescription() const { return m_PipelineDescription; }
+	VkPipelineLayout GetLayout() const { return m_PipelineLayout; }
+
+	//Stages of every range overlapping the bytes, vkCmdPushConstants has to name all of them
+	VkShaderStageFlags GetPushConstantStages(uint32_t offset, uint32_t size) const {
+		VkShaderStageFlags stages = 0;
+		for (const auto& range : m_PipelineDescription.PushConstantRanges) {
+			if (offset < range.Offset + range.Size && range.Offset < offset + size)
+				stages |= range.Stages;
+		}
+		return stages;
+	}
+
+	//Throws unless every byte is covered by ranges of exactly these stages, the rule vkCmdPushConstants is held to
+	void ValidatePushConstants(uint32_t offset, uint32_t size, VkShaderStageFlags stages) const;
+
+	//End of the furthest push constant range
+	uint32_t GetPushConstantSize() const { return m_PushConstantSize; }
+public:
+	//What every device has to support as maxPushConstantsSize, larger blocks only work on some
+	static const uint32_t MIN_PUSH_CONSTANTS_SIZE = 128;
+
 	inline VkSwapchainKHR GetSwapchain() const { return m_PipelineDescription.Framebuffer->GetSwapchain(); }
 	inline VkExtent2D GetExtent() const { return m_PipelineDescription.Framebuffer->GetExtent(); }
 	inline VkRenderPass GetRenderPass() const { return m_PipelineDescription.Framebuffer->GetRenderPass(); }
@@ -61,7 +196,19 @@ private:
 	void CreatePipeline();
 private:
 	PipelineDescription m_PipelineDescription;
-	VkPipeline m_Pipeline;
-	VkPipelineLayout m_PipelineLayout;
+	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+
+	//What the pipeline was built against
+	VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+	VkExtent2D m_Extent{};
+
+	uint32_t m_PushConstantSize = 0;
+
+	std::atomic<bool> m_Ready = false;
+	std::atomic<bool> m_Failed = false;
+	std::promise<void> m_Compiled;
+	std::shared_future<void> m_CompiledFuture;
+	double m_CompileTime = 0.0;
 };
 
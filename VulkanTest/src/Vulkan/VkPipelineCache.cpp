@@ -0,0 +1,125 @@
+#include "VkPipelineCache.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+void PipelineCache::Init(VkDevice device, VkPhysicalDevice physicalDevice, const std::filesystem::path& path) {
+    m_Device = device;
+    m_Path = path;
+    vkGetPhysicalDeviceProperties(physicalDevice, &m_Properties);
+
+    std::vector<char> data;
+    std::ifstream file(m_Path, std::ios::ate | std::ios::binary);
+    if (file.is_open()) {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), data.size());
+        file.close();
+
+        if (!IsCompatible(data)) {
+            std::cout << "pipeline cache: " << m_Path.string() << " was written by a different device or driver, starting empty" << std::endl;
+            data.clear();
+        }
+    }
+
+    m_Loaded = !data.empty();
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_Cache) != VK_SUCCESS) {
+        //The driver may still refuse data that passed the header check, fall back to an empty cache
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        m_Loaded = false;
+
+        if (vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_Cache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+    }
+}
+
+void PipelineCache::Shutdown() {
+    Save();
+
+    vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+    m_Cache = VK_NULL_HANDLE;
+}
+
+void PipelineCache::RecordPipeline(double creationTime, const VkPipelineCreationFeedbackEXT* feedback) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Stats.PipelineCount++;
+    m_Stats.TotalCreationTime += creationTime;
+
+    if (feedback == nullptr || !(feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT))
+        m_Stats.Unknown++;
+    else if (feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT)
+        m_Stats.CacheHits++;
+    else
+        m_Stats.CacheMisses++;
+}
+
+PipelineCacheStats PipelineCache::GetStats() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void PipelineCache::PrintStats() {
+    PipelineCacheStats stats = GetStats();
+
+    std::cout << "pipeline cache: " << (m_Loaded ? "loaded from " + m_Path.string() : std::string("cold")) << ", "
+        << stats.PipelineCount << " pipelines created in " << stats.TotalCreationTime << " ms, "
+        << stats.CacheHits << " hits, " << stats.CacheMisses << " misses";
+
+    if (stats.Unknown > 0)
+        std::cout << ", " << stats.Unknown << " unknown";
+
+    std::cout << std::endl;
+}
+
+bool PipelineCache::IsCompatible(const std::vector<char>& data) const {
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header))
+        return false;
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    return header.headerSize >= sizeof(header)
+        && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        && header.vendorID == m_Properties.vendorID
+        && header.deviceID == m_Properties.deviceID
+        && memcmp(header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void PipelineCache::Save() {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(m_Device, m_Cache, &size, nullptr) != VK_SUCCESS || size == 0)
+        return;
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(m_Device, m_Cache, &size, data.data()) != VK_SUCCESS)
+        return;
+
+    //Written next to the old file first so a crash mid write never leaves a truncated cache behind
+    std::filesystem::path tempPath = m_Path;
+    tempPath += ".tmp";
+
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "pipeline cache: failed to write " << tempPath.string() << std::endl;
+        return;
+    }
+
+    file.write(data.data(), size);
+    file.close();
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, m_Path, error);
+    if (error)
+        std::cerr << "pipeline cache: failed to replace " << m_Path.string() << ": " << error.message() << std::endl;
+}
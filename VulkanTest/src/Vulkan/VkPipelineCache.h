@@ -0,0 +1,49 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <filesystem>
+#include <mutex>
+
+struct PipelineCacheStats {
+	uint32_t PipelineCount = 0;
+
+	//Only known when VK_EXT_pipeline_creation_feedback is available, otherwise every pipeline counts as unknown
+	uint32_t CacheHits = 0;
+	uint32_t CacheMisses = 0;
+	uint32_t Unknown = 0;
+
+	double TotalCreationTime = 0.0;	//Milliseconds
+};
+
+//Device wide VkPipelineCache that is loaded from disk on startup and written back on shutdown
+class PipelineCache {
+public:
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice, const std::filesystem::path& path = DEFAULT_PATH);
+	void Shutdown();
+
+	//Called once per vkCreateGraphicsPipelines, feedback is nullptr when the extension isn't enabled
+	void RecordPipeline(double creationTime, const VkPipelineCreationFeedbackEXT* feedback);
+
+	VkPipelineCache GetCache() const { return m_Cache; }
+	bool WasLoaded() const { return m_Loaded; }
+
+	PipelineCacheStats GetStats();
+	void PrintStats();
+public:
+	inline static const char* DEFAULT_PATH = "pipeline_cache.bin";
+private:
+	//Data written by a different driver or GPU has to be thrown away, drivers don't all reject it themselves
+	bool IsCompatible(const std::vector<char>& data) const;
+	void Save();
+private:
+	VkDevice m_Device = VK_NULL_HANDLE;
+	VkPhysicalDeviceProperties m_Properties{};
+
+	VkPipelineCache m_Cache = VK_NULL_HANDLE;
+	std::filesystem::path m_Path;
+	bool m_Loaded = false;
+
+	PipelineCacheStats m_Stats;
+	std::mutex m_Mutex;
+};
@@ -0,0 +1,214 @@
+#include "VkPipelineLibrary.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+#include "Core/Hash.h"
+
+std::shared_ptr<Pipeline> PipelineLibrary::GetPipeline(const PipelineDescription& description) {
+    std::vector<uint64_t> key = BuildKey(description);
+    uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+    bool created;
+    std::shared_ptr<Pipeline> pipeline = FindOrCreate(description, std::move(key), hash, created);
+
+    //Compiled outside the lock, racing requests for the same pipeline find the entry and wait on it. A failed
+    //compile throws its own error, the entry is dropped and retried by the next request.
+    if (created)
+        pipeline->Compile();
+    else if (!pipeline->IsReady())
+        pipeline->Wait();
+
+    if (pipeline->HasFailed()) {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+
+    return pipeline;
+}
+
+std::shared_ptr<Pipeline> PipelineLibrary::GetPipelineAsync(const PipelineDescription& description) {
+    std::vector<uint64_t> key = BuildKey(description);
+    uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+    bool created;
+    std::shared_ptr<Pipeline> pipeline = FindOrCreate(description, std::move(key), hash, created);
+    if (!created)
+        return pipeline;
+
+    auto requestTime = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_CompilePool)
+        m_CompilePool = std::make_unique<ThreadPool>();
+
+    m_CompilePool->Submit([this, pipeline, hash, requestTime]() {
+        try {
+            pipeline->Compile();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "pipeline library: async compile failed: " << e.what() << std::endl;
+        }
+
+        std::chrono::duration<double, std::milli> latency = std::chrono::high_resolution_clock::now() - requestTime;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stats.AsyncCompileCount++;
+        m_Stats.AsyncCompileFailures += pipeline->HasFailed();
+        m_Stats.AsyncLatencyTotal += latency.count();
+        m_Stats.AsyncLatencyMax = (std::max)(m_Stats.AsyncLatencyMax, latency.count());
+
+        if (m_Stats.AsyncCompiles.size() == PipelineLibraryStats::MAX_ASYNC_COMPILE_RECORDS)
+            m_Stats.AsyncCompiles.pop_front();
+        m_Stats.AsyncCompiles.push_back({ hash, latency.count(), pipeline->GetCompileTime(), pipeline->HasFailed() });
+    });
+
+    return pipeline;
+}
+
+void PipelineLibrary::WaitIdle() {
+    if (m_CompilePool)
+        m_CompilePool->WaitIdle();
+}
+
+void PipelineLibrary::Clear() {
+    //Workers still hold on to pipelines that are compiling, they have to finish before the device goes away
+    m_CompilePool.reset();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Pipelines.clear();
+}
+
+void PipelineLibrary::RecreateSwapchain() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    //Pipelines with a baked in extent end up under a different key once they are rebuilt
+    std::unordered_map<uint64_t, std::vector<Entry>> pipelines;
+    for (const auto& [hash, entries] : m_Pipelines) {
+        for (const auto& entry : entries) {
+            std::shared_ptr<Pipeline> pipeline = entry.Instance.lock();
+            if (!pipeline || pipeline->HasFailed())
+                continue;
+
+            pipeline->RecreateSwapchain();
+
+            std::vector<uint64_t> key = BuildKey(pipeline->GetDescription());
+            uint64_t newHash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+            pipelines[newHash].push_back({ std::move(key), pipeline });
+        }
+    }
+
+    m_Pipelines.swap(pipelines);
+}
+
+std::shared_ptr<Pipeline> PipelineLibrary::FindOrCreate(const PipelineDescription& description, std::vector<uint64_t> key, uint64_t hash, bool& created) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::vector<Entry>& entries = m_Pipelines[hash];
+
+    //Drop pipelines nobody uses anymore so their handles can't be mistaken for live ones, and failed ones so they get retried
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry& entry) {
+        std::shared_ptr<Pipeline> pipeline = entry.Instance.lock();
+        return !pipeline || pipeline->HasFailed();
+    }), entries.end());
+
+    created = false;
+    for (const auto& entry : entries) {
+        if (entry.Key == key) {
+            m_Stats.Hits++;
+            return entry.Instance.lock();
+        }
+    }
+
+    //Only inserted here, whoever created it compiles it once the lock is released
+    std::shared_ptr<Pipeline> pipeline = std::make_shared<Pipeline>(description, true);
+    entries.push_back({ std::move(key), pipeline });
+    m_Stats.Misses++;
+    created = true;
+
+    return pipeline;
+}
+
+PipelineLibraryStats PipelineLibrary::GetStats() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    PipelineLibraryStats stats = m_Stats;
+    stats.LivePipelines = 0;
+    for (const auto& [hash, entries] : m_Pipelines) {
+        for (const auto& entry : entries) {
+            if (!entry.Instance.expired())
+                stats.LivePipelines++;
+        }
+    }
+
+    return stats;
+}
+
+void PipelineLibrary::PrintStats() {
+    PipelineLibraryStats stats = GetStats();
+
+    std::cout << "pipeline library: " << stats.LivePipelines << " live pipelines, "
+        << stats.Hits << " requests shared an existing pipeline, " << stats.Misses << " created" << std::endl;
+
+    if (stats.AsyncCompileCount > 0) {
+        std::cout << "    " << stats.AsyncCompileCount << " async compiles, " << stats.AsyncCompileFailures << " failed, "
+            << stats.AsyncLatencyTotal / stats.AsyncCompileCount << " ms mean latency, " << stats.AsyncLatencyMax << " ms max" << std::endl;
+    }
+
+    for (const auto& record : stats.AsyncCompiles) {
+        std::cout << "    pipeline " << std::hex << record.Hash << std::dec << ": "
+            << (record.Failed ? "failed" : "ready") << " after " << record.Latency << " ms, "
+            << record.CompileTime << " ms compiling" << std::endl;
+    }
+}
+
+std::vector<uint64_t> PipelineLibrary::BuildKey(const PipelineDescription& description) {
+    std::vector<uint64_t> key;
+
+    key.push_back(description.Shaders->GetHash());
+
+    //Anything compatible with the render pass can share a pipeline, handles are reused once a render pass is destroyed
+    key.push_back(description.Framebuffer->GetColorFormat());
+    key.push_back(description.Framebuffer->GetSampleCount());
+    if (!description.HasDynamicViewport()) {
+        key.push_back(description.Framebuffer->GetExtent().width);
+        key.push_back(description.Framebuffer->GetExtent().height);
+    }
+
+    key.push_back(description.VertexLayouts.size());
+    for (const auto& layout : description.VertexLayouts) {
+        key.push_back(layout.GetStride());
+        key.push_back(layout.GetElements().size());
+
+        for (const auto& element : layout) {
+            key.push_back(static_cast<uint64_t>(element.Type));
+            key.push_back(element.Offset);
+            key.push_back(element.ColumnStride);
+            key.push_back(element.InstancedDivisor);
+            key.push_back(element.Normalized);
+        }
+    }
+
+    //Layouts are shared objects, pipelines built from the same one are compatible
+    key.push_back(description.DescriptorSetLayouts.size());
+    for (const auto& setLayout : description.DescriptorSetLayouts)
+        key.push_back((uint64_t)setLayout->GetLayout());
+
+    key.push_back(description.PushConstantRanges.size());
+    for (const auto& range : description.PushConstantRanges) {
+        key.push_back(range.Stages);
+        key.push_back(range.Offset);
+        key.push_back(range.Size);
+    }
+
+    key.push_back(static_cast<uint64_t>(description.Topology));
+    key.push_back(static_cast<uint64_t>(description.Cull));
+    key.push_back(static_cast<uint64_t>(description.Blend));
+    key.push_back(description.Wireframe);
+
+    std::vector<VkDynamicState> dynamicStates = description.GetVkDynamicStates();
+    key.push_back(dynamicStates.size());
+    for (VkDynamicState state : dynamicStates)
+        key.push_back(state);
+
+    return key;
+}
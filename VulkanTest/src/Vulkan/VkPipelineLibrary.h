@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <string>
+
+#include "VkPipeline.h"
+#include "Core/ThreadPool.h"
+
+struct PipelineCompileRecord {
+	uint64_t Hash;
+	double Latency;		//Milliseconds from the request until the pipeline was ready
+	double CompileTime;	//Milliseconds spent in vkCreateGraphicsPipelines
+	bool Failed;
+};
+
+struct PipelineLibraryStats {
+	uint32_t Hits = 0;
+	uint32_t Misses = 0;
+	uint32_t LivePipelines = 0;
+
+	//Totals over every async compile, the records below only keep the most recent ones
+	uint32_t AsyncCompileCount = 0;
+	uint32_t AsyncCompileFailures = 0;
+	double AsyncLatencyTotal = 0.0;
+	double AsyncLatencyMax = 0.0;
+
+	static constexpr size_t MAX_ASYNC_COMPILE_RECORDS = 64;
+	std::deque<PipelineCompileRecord> AsyncCompiles;
+};
+
+//Hands out shared pipelines so identical descriptions only ever get compiled once.
+//Entries are weak, a pipeline is destroyed as soon as the last user lets go of it.
+class PipelineLibrary {
+public:
+	//Compiles on the calling thread, or waits for an async compile of the same pipeline that is still running
+	std::shared_ptr<Pipeline> GetPipeline(const PipelineDescription& description);
+
+	//Returns right away, the pipeline compiles on a worker thread and reports IsReady once it can be bound
+	std::shared_ptr<Pipeline> GetPipelineAsync(const PipelineDescription& description);
+
+	void WaitIdle();
+	void Clear();
+
+	//Called after the framebuffers were recreated, every live pipeline is rebuilt if it can't be used with them anymore.
+	//Async compiles read the framebuffer, WaitIdle has to be called before it is recreated.
+	void RecreateSwapchain();
+
+	PipelineLibraryStats GetStats();
+	void PrintStats();
+private:
+	//Every piece of state that ends up in vkCreateGraphicsPipelines, flattened so it can be hashed and compared
+	static std::vector<uint64_t> BuildKey(const PipelineDescription& description);
+
+	//created is set when the returned pipeline is new, the caller has to compile it
+	std::shared_ptr<Pipeline> FindOrCreate(const PipelineDescription& description, std::vector<uint64_t> key, uint64_t hash, bool& created);
+private:
+	struct Entry {
+		std::vector<uint64_t> Key;
+		std::weak_ptr<Pipeline> Instance;
+	};
+
+	std::unordered_map<uint64_t, std::vector<Entry>> m_Pipelines;
+	PipelineLibraryStats m_Stats;
+
+	//Only started once the first async pipeline is requested
+	std::unique_ptr<ThreadPool> m_CompilePool;
+
+	std::mutex m_Mutex;
+};
@@ -0,0 +1,144 @@
+#include "VkReadback.h"
+
+#include <algorithm>
+
+#include "VkDevice.h"
+
+void FrameReadback::Init(uint32_t frameCount) {
+    m_Slots.resize(frameCount);
+}
+
+void FrameReadback::Shutdown() {
+    for (auto& slot : m_Slots)
+        DestroySlot(slot);
+
+    m_Slots.clear();
+}
+
+void FrameReadback::Record(VkCommandBuffer commandBuffer, uint32_t frame, VkImage image, VkExtent2D extent, VkFormat format, uint64_t frameIndex) {
+    Slot& slot = m_Slots[frame];
+
+    //Only 4 byte formats are rendered offscreen
+    EnsureCapacity(slot, static_cast<VkDeviceSize>(extent.width) * extent.height * 4);
+
+    //The render pass leaves the image in TRANSFER_SRC_OPTIMAL, but its writes still have to be made visible to the copy
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = image;
+    imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.Buffer, 1, &region);
+
+    VkBufferMemoryBarrier bufferBarrier{};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = slot.Buffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+    slot.Extent = extent;
+    slot.Format = format;
+    slot.FrameIndex = frameIndex;
+    slot.Pending = true;
+}
+
+void FrameReadback::Deliver(uint32_t frame, const ReadbackCallback& callback) {
+    Slot& slot = m_Slots[frame];
+    if (!slot.Pending)
+        return;
+
+    slot.Pending = false;
+    if (!callback)
+        return;
+
+    VkDeviceSize size = static_cast<VkDeviceSize>(slot.Extent.width) * slot.Extent.height * 4;
+    Device::Get().GetAllocator().Invalidate(slot.Allocation, 0, size);
+
+    ReadbackImage image{};
+    image.Data = static_cast<const uint8_t*>(slot.MappedData);
+    image.Width = slot.Extent.width;
+    image.Height = slot.Extent.height;
+    image.RowPitch = slot.Extent.width * 4;
+    image.Format = slot.Format;
+    image.FrameIndex = slot.FrameIndex;
+
+    callback(image);
+}
+
+void FrameReadback::DeliverAll(const ReadbackCallback& callback) {
+    std::vector<uint32_t> pending;
+    for (uint32_t i = 0; i < m_Slots.size(); i++) {
+        if (m_Slots[i].Pending)
+            pending.push_back(i);
+    }
+
+    std::sort(pending.begin(), pending.end(), [this](uint32_t a, uint32_t b) { return m_Slots[a].FrameIndex < m_Slots[b].FrameIndex; });
+
+    for (uint32_t frame : pending)
+        Deliver(frame, callback);
+}
+
+void FrameReadback::EnsureCapacity(Slot& slot, VkDeviceSize size) {
+    if (slot.Buffer != VK_NULL_HANDLE && slot.Size >= size)
+        return;
+
+    DestroySlot(slot);
+
+    VkDevice device = Device::Get().GetDevice();
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &slot.Buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create readback buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, slot.Buffer, &memRequirements);
+
+    //Cached memory makes the CPU reads fast, uncached host memory is very slow to read from
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    slot.Allocation = allocator.Allocate(memRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, MemoryResourceType::Linear, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    vkBindBufferMemory(device, slot.Buffer, slot.Allocation.Memory, slot.Allocation.Offset);
+
+    slot.MappedData = allocator.Map(slot.Allocation);
+    slot.Size = size;
+}
+
+void FrameReadback::DestroySlot(Slot& slot) {
+    if (slot.Buffer == VK_NULL_HANDLE)
+        return;
+
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    allocator.Unmap(slot.Allocation);
+    vkDestroyBuffer(Device::Get().GetDevice(), slot.Buffer, nullptr);
+    allocator.Free(slot.Allocation);
+
+    slot = Slot{};
+}
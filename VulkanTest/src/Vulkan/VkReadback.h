@@ -0,0 +1,57 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <functional>
+
+#include "VkMemoryAllocator.h"
+
+struct ReadbackImage {
+	const uint8_t* Data;
+	uint32_t Width, Height;
+	uint32_t RowPitch;
+	VkFormat Format;
+
+	//Counts every frame the renderer has submitted, so callers can tell frames apart
+	uint64_t FrameIndex;
+};
+
+using ReadbackCallback = std::function<void(const ReadbackImage&)>;
+
+//Copies rendered images into host memory without stalling. Every frame in flight has its own buffer, the copy is
+//recorded at the end of the frame and only read once that frame's fence has signaled, so the CPU never waits on it.
+class FrameReadback {
+public:
+	void Init(uint32_t frameCount);
+	void Shutdown();
+
+	//image has to be in TRANSFER_SRC_OPTIMAL, which is where offscreen framebuffers leave it
+	void Record(VkCommandBuffer commandBuffer, uint32_t frame, VkImage image, VkExtent2D extent, VkFormat format, uint64_t frameIndex);
+
+	//Only call once the frame's fence has signaled
+	void Deliver(uint32_t frame, const ReadbackCallback& callback);
+
+	//Forgets the copy recorded for a frame that never got submitted
+	void Discard(uint32_t frame) { m_Slots[frame].Pending = false; }
+
+	//Hands out everything still pending in submission order, the device has to be idle
+	void DeliverAll(const ReadbackCallback& callback);
+private:
+	struct Slot {
+		VkBuffer Buffer = VK_NULL_HANDLE;
+		MemoryAllocation Allocation;
+		void* MappedData = nullptr;
+		VkDeviceSize Size = 0;
+
+		VkExtent2D Extent{};
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		uint64_t FrameIndex = 0;
+		bool Pending = false;
+	};
+
+	//Buffers are kept and reused, they only get replaced when a bigger image comes along
+	void EnsureCapacity(Slot& slot, VkDeviceSize size);
+	void DestroySlot(Slot& slot);
+private:
+	std::vector<Slot> m_Slots;
+};
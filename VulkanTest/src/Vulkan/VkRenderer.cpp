@@ -2,88 +2,257 @@
 #include <stdexcept>
 #include <algorithm>
 #include <fstream>
+#include <chrono>
 
 #include "VkDevice.h"
 #include "VkRendererAPI.h"
 
 #include "Application.h"
 #include "Renderer/RenderCommand.h"
+#include "Core/Instrumentor.h"
 
 void Renderer::Init() {
-    //Vertex Buffer Init
-    BufferDescription bufferDescription{};
-    bufferDescription.Type = BufferType::VertexBuffer;
-    bufferDescription.Size = s_Data.MaxVertices * sizeof(QuadVertex);
-    bufferDescription.Layout = {
-        { ShaderDataType::Float2, "a_Position" },
-		{ ShaderDataType::Float3, "a_Color" }
-	};
-
-    std::shared_ptr<Buffer> vertexBuffer = std::make_shared<Buffer>(bufferDescription);
-    vertexBuffer->SetData(s_Data.vertices.data(), s_Data.vertices.size() * sizeof(QuadVertex));
+    //Index Buffer Init
+    //Every quad is two clockwise triangles over its four corners, so one buffer covers every batch
+    std::vector<uint32_t> quadIndices(s_Data.MaxIndices);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < s_Data.MaxIndices; i += 6) {
+        quadIndices[i + 0] = offset + 0;
+        quadIndices[i + 1] = offset + 1;
+        quadIndices[i + 2] = offset + 2;
+
+        quadIndices[i + 3] = offset + 2;
+        quadIndices[i + 4] = offset + 3;
+        quadIndices[i + 5] = offset + 0;
+
+        offset += 4;
+    }
+
+    BufferDescription indexBufferDescription{};
+    indexBufferDescription.Type = BufferType::IndexBuffer;
+    indexBufferDescription.MemoryType = BufferMemoryType::DeviceLocal;
+    indexBufferDescription.Size = s_Data.MaxIndices * sizeof(uint32_t);
+
+    s_Data.m_QuadIndexBuffer = std::make_shared<Buffer>(indexBufferDescription);
+    s_Data.m_QuadIndexBuffer->SetIndices(quadIndices.data(), s_Data.MaxIndices);
+
+    s_Data.m_QuadVertices.reserve(s_Data.MaxVertices);
+    s_Data.m_QuadVertexBuffers.resize(Device::MAX_FRAMES_IN_FLIGHT);
 
     //Framebuffer Init
     FramebufferDescription framebufferDescriptions{};
     framebufferDescriptions.Attachments = { {FramebufferTextureFormat::RGBA8} };
-    framebufferDescriptions.Width = 1280;
-    framebufferDescriptions.Height = 720;
+    framebufferDescriptions.Width = Application::Get().GetWindow().GetWidth();
+    framebufferDescriptions.Height = Application::Get().GetWindow().GetHeight();
+    framebufferDescriptions.SwapChainTarget = !Device::Get().IsHeadless();
+    //One image for every frame that could be in flight, so changing the frame count never recreates the framebuffer
+    framebufferDescriptions.ImageCount = Device::MAX_FRAMES_IN_FLIGHT;
+    framebufferDescriptions.PreferredPresentMode = Application::Get().GetSpecification().PreferredPresentMode;
+    framebufferDescriptions.SwapChainImageCount = Application::Get().GetSpecification().SwapChainImageCount;
     std::shared_ptr<Framebuffer> framebuffer = std::make_shared<Framebuffer>(framebufferDescriptions);
 
     //Pipeline Init
     PipelineDescription pipelineDescription{};
     pipelineDescription.Framebuffer = framebuffer;
     pipelineDescription.Shaders = std::make_shared<Shader>((std::filesystem::path)"shaders/vert.spv", (std::filesystem::path)"shaders/frag.spv");
-    pipelineDescription.VertexBuffer = vertexBuffer;
+    pipelineDescription.VertexLayouts = {
+        {
+            { ShaderDataType::Float2, "a_Position" },
+            { ShaderDataType::Float3, "a_Color" }
+        }
+    };
     pipelineDescription.DynamicStates = { DynamicStates::Viewport, DynamicStates::Scissor };
 
-    s_Data.m_Pipeline = std::make_unique<Pipeline>(pipelineDescription);
+    s_Data.m_Pipeline = GetPipeline(pipelineDescription);
+
+    Device::Get().GetPipelineCache().PrintStats();
 
     CreateCommandPool();
     CreateCommandBuffer();
+    CreateRecordingContexts();
 
     CreateSyncObjects();
+
+    s_Data.m_Readback.Init(Device::MAX_FRAMES_IN_FLIGHT);
+    s_Data.m_FramePacer.Init(Device::MAX_FRAMES_IN_FLIGHT);
+    s_Data.m_GpuProfiler.Init(Device::MAX_FRAMES_IN_FLIGHT);
+    s_Data.m_UniformRing.Init();
+
+    if (Device::Get().IsBindlessSupported())
+        s_Data.m_BindlessHeap.Init();
 }
 
 void Renderer::Shutdown() {
     VkDevice device = Device::Get().GetDevice();
     vkDeviceWaitIdle(device);
 
+    //The last frames are still sitting in their readback buffers
+    s_Data.m_Readback.DeliverAll(s_Data.m_ReadbackCallback);
+    s_Data.m_Readback.Shutdown();
+
+    s_Data.m_GpuProfiler.PrintStats();
+    s_Data.m_GpuProfiler.Shutdown();
+    s_Data.m_UniformRing.Shutdown();
+    s_Data.m_BindlessHeap.Shutdown();
+
     vkDestroyCommandPool(device, s_Data.m_CommandPool, nullptr);
 
+    for (auto& contexts : s_Data.m_RecordingContexts) {
+        for (auto& context : contexts)
+            vkDestroyCommandPool(device, context.CommandPool, nullptr);
+    }
+    s_Data.m_RecordingContexts.clear();
+
     for (size_t i = 0; i < Device::MAX_FRAMES_IN_FLIGHT; i++) {
         vkDestroySemaphore(device, s_Data.m_RenderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(device, s_Data.m_ImageAvailableSemaphores[i], nullptr);
         vkDestroyFence(device, s_Data.m_InFlightFences[i], nullptr);
     }
 
+    s_Data.m_QuadVertexBuffers.clear();
+    s_Data.m_QuadIndexBuffer.reset();
+    s_Data.m_PipelineLibrary.PrintStats();
+
+    s_Data.m_QuadPipeline.reset();
     s_Data.m_Pipeline.reset();
+    s_Data.m_PipelineLibrary.Clear();
+
+    Device::Get().GetDeletionQueue().Flush();
+}
+
+void Renderer::BeginScene() {
+    s_Data.m_QuadVertices.clear();
+    s_Data.m_QuadBatchCounts.clear();
+    s_Data.m_QuadIndexCount = 0;
+    s_Data.m_SceneCommands.clear();
+
+    s_Data.m_Stats.DrawCalls = 0;
+    s_Data.m_Stats.QuadCount = 0;
+    s_Data.m_Stats.SecondaryCommandBuffers = 0;
+}
+
+void Renderer::EndScene() {
+    if (s_Data.m_QuadIndexCount > 0)
+        NextBatch();
+}
+
+void Renderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec3& color) {
+    if (s_Data.m_QuadIndexCount >= s_Data.MaxIndices)
+        NextBatch();
+
+    s_Data.m_QuadVertices.push_back({ { position.x, position.y }, color });
+    s_Data.m_QuadVertices.push_back({ { position.x + size.x, position.y }, color });
+    s_Data.m_QuadVertices.push_back({ { position.x + size.x, position.y + size.y }, color });
+    s_Data.m_QuadVertices.push_back({ { position.x, position.y + size.y }, color });
+
+    s_Data.m_QuadIndexCount += 6;
+    s_Data.m_Stats.QuadCount++;
+}
+
+void Renderer::NextBatch() {
+    s_Data.m_QuadBatchCounts.push_back(s_Data.m_QuadIndexCount);
+    s_Data.m_QuadIndexCount = 0;
+}
+
+void Renderer::SetFramesInFlight(uint32_t framesInFlight) {
+    vkDeviceWaitIdle(Device::Get().GetDevice());
+
+    //Slots beyond the new count would never be reused, so hand out what they hold now
+    s_Data.m_Readback.DeliverAll(s_Data.m_ReadbackCallback);
+
+    //Frame slots start over, everything retired so far is done with anyway
+    Device::Get().GetDeletionQueue().Flush();
+
+    Device::Get().SetFramesInFlight(framesInFlight);
+    s_Data.m_FramePacer.Reset();
+}
+
+void Renderer::SetPresentMode(PresentMode presentMode) {
+    const std::shared_ptr<Framebuffer>& framebuffer = GetFramebuffer();
+    if (!framebuffer->IsSwapChainTarget())
+        return;
+
+    framebuffer->SetPresentMode(presentMode);
+    RecreateSwapchain();
+}
+
+void Renderer::SetSwapChainImageCount(uint32_t imageCount) {
+    const std::shared_ptr<Framebuffer>& framebuffer = GetFramebuffer();
+    if (!framebuffer->IsSwapChainTarget())
+        return;
+
+    framebuffer->SetSwapChainImageCount(imageCount);
+    RecreateSwapchain();
+}
+
+void Renderer::PaceFrame() {
+    s_Data.m_FramePacer.BeginFrame(Device::Get().GetDevice(), s_Data.m_InFlightFences);
 }
 
 void Renderer::DrawFrame() {
+    PROFILE_FUNCTION();
+
     VkDevice device = Device::Get().GetDevice();
     const uint32_t currentFrame = Device::Get().GetCurrentFrame();
 
-    vkWaitForFences(device, 1, &s_Data.m_InFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    {
+        PROFILE_SCOPE("WaitForFrame");
+        s_Data.m_FramePacer.WaitForFrame(device, s_Data.m_InFlightFences[currentFrame], currentFrame);
+    }
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(device, s_Data.m_Pipeline->GetSwapchain(), UINT64_MAX, s_Data.m_ImageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+    //Frames finish in submission order, so the one that used this slot last and every frame before it are done
+    const uint32_t framesInFlight = Device::Get().GetFramesInFlight();
+    if (s_Data.m_FrameIndex >= framesInFlight)
+        Device::Get().GetDeletionQueue().Collect(s_Data.m_FrameIndex - framesInFlight + 1);
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-        RecreateSwapchain();
-        return;
+    //The frame that used this slot before is done, so its readback can be handed out without waiting
+    s_Data.m_Readback.Deliver(currentFrame, s_Data.m_ReadbackCallback);
+
+    const bool headless = Device::Get().IsHeadless();
+
+    //Offscreen framebuffers have one image per frame in flight, there is nothing to acquire
+    uint32_t imageIndex = currentFrame;
+    VkResult result;
+    if (!headless) {
+        PROFILE_SCOPE("AcquireNextImage");
+        result = vkAcquireNextImageKHR(device, s_Data.m_Pipeline->GetSwapchain(), UINT64_MAX, s_Data.m_ImageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+        //A suboptimal swapchain still has an image acquired and a semaphore about to signal, so that frame is
+        //rendered and presented before recreating
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            RecreateSwapchain();
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
     }
 
-    vkResetFences(device, 1, &s_Data.m_InFlightFences[currentFrame]);
+    //Scene commands allocate their uniforms while the frame is recorded, the GPU is done with this frame's region
+    s_Data.m_UniformRing.BeginFrame();
 
     vkResetCommandBuffer(s_Data.m_CommandBuffers[currentFrame], 0);
-    RecordCommandBuffer(s_Data.m_CommandBuffers[currentFrame], imageIndex);
+    try {
+        RecordCommandBuffer(s_Data.m_CommandBuffers[currentFrame], imageIndex);
+        s_Data.m_UniformRing.Flush();
+
+        //Uploads recorded since the last frame go to the queue ahead of the frame that uses them
+        Device::Get().GetStagingBuffer().Flush();
+    }
+    catch (...) {
+        AbandonFrame(currentFrame, headless);
+        throw;
+    }
+
+    //Only now, a frame that throws while recording leaves the fence signaled so the slot isn't waited on forever
+    vkResetFences(device, 1, &s_Data.m_InFlightFences[currentFrame]);
 
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
     VkSemaphore waitSemaphores[] = { s_Data.m_ImageAvailableSemaphores[currentFrame] };
     VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = headless ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
@@ -91,13 +260,23 @@ void Renderer::DrawFrame() {
     submitInfo.pCommandBuffers = &s_Data.m_CommandBuffers[currentFrame];
 
     VkSemaphore signalSemaphores[] = { s_Data.m_RenderFinishedSemaphores[currentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    if (vkQueueSubmit(Device::Get().GetGraphicsQueue(), 1, &submitInfo, s_Data.m_InFlightFences[currentFrame]) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit draw command buffer!");
+    {
+        PROFILE_SCOPE("QueueSubmit");
+        if (vkQueueSubmit(Device::Get().GetGraphicsQueue(), 1, &submitInfo, s_Data.m_InFlightFences[currentFrame]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
     }
 
+    s_Data.m_FramePacer.OnSubmit(currentFrame);
+    Device::Get().GetDeletionQueue().OnFrameSubmitted();
+    s_Data.m_FrameIndex++;
+
+    if (headless)
+        return;
+
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
@@ -110,7 +289,46 @@ void Renderer::DrawFrame() {
 
     presentInfo.pImageIndices = &imageIndex;
 
-    result = vkQueuePresentKHR(Device::Get().GetPresentQueue(), &presentInfo);
+    {
+        PROFILE_SCOPE("QueuePresent");
+        result = vkQueuePresentKHR(Device::Get().GetPresentQueue(), &presentInfo);
+    }
+
+    const bool resized = Application::Get().GetWindow().PollResized();
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || resized) {
+        RecreateSwapchain();
+    }
+    else if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to present swap chain image!");
+    }
+}
+
+void Renderer::AbandonFrame(uint32_t currentFrame, bool headless) {
+    //Recording may have stopped in the middle of the render pass
+    vkResetCommandBuffer(s_Data.m_CommandBuffers[currentFrame], 0);
+    s_Data.m_Readback.Discard(currentFrame);
+
+    if (headless)
+        return;
+
+    //The acquire still signals the semaphore. Waiting on it in an empty submission that signals the fence leaves the
+    //slot as if the frame had run. The acquired image can't be presented without being rendered to, it is released
+    //along with the swapchain instead.
+    VkDevice device = Device::Get().GetDevice();
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &s_Data.m_ImageAvailableSemaphores[currentFrame];
+    submitInfo.pWaitDstStageMask = &waitStage;
+
+    vkResetFences(device, 1, &s_Data.m_InFlightFences[currentFrame]);
+    if (vkQueueSubmit(Device::Get().GetGraphicsQueue(), 1, &submitInfo, s_Data.m_InFlightFences[currentFrame]) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit the wait of an abandoned frame!");
+    }
+
+    RecreateSwapchain();
 }
 
 void Renderer::CreateCommandPool() {
@@ -143,6 +361,8 @@ void Renderer::CreateCommandBuffer() {
 }
 
 void Renderer::RecordCommandBuffer(const VkCommandBuffer commandBuffer, const uint32_t imageIndex) {
+    PROFILE_FUNCTION();
+
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     beginInfo.flags = 0; // Optional
@@ -152,6 +372,10 @@ void Renderer::RecordCommandBuffer(const VkCommandBuffer commandBuffer, const ui
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
+    GpuProfiler& profiler = s_Data.m_GpuProfiler;
+    profiler.BeginFrame(commandBuffer, Device::Get().GetCurrentFrame());
+    uint32_t frameScope = profiler.BeginScope(commandBuffer, "Frame");
+
     VkExtent2D extent = s_Data.m_Pipeline->GetExtent();
 
     VkRenderPassBeginInfo renderPassInfo{};
@@ -166,9 +390,85 @@ void Renderer::RecordCommandBuffer(const VkCommandBuffer commandBuffer, const ui
     renderPassInfo.clearValueCount = 1;
     renderPassInfo.pClearValues = &clearColorValue;
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    //Never wait on a pipeline that is still compiling, draw with the default one in the meantime
+    Pipeline* pipeline = s_Data.m_Pipeline.get();
+    if (s_Data.m_QuadPipeline && s_Data.m_QuadPipeline->IsReady())
+        pipeline = s_Data.m_QuadPipeline.get();
+    else if (s_Data.m_QuadPipeline && !s_Data.m_QuadPipeline->HasFailed())
+        s_Data.m_Stats.FallbackFrames++;
+
+    PrepareBatches();
+
+    //Splitting only pays off when every thread gets a few draws
+    const uint32_t itemCount = GetDrawItemCount();
+    const uint32_t sliceCount = (std::min)(s_Data.m_RecordingThreads, itemCount / RendererData::MinDrawItemsPerSlice);
+
+    uint32_t renderPassScope = profiler.BeginScope(commandBuffer, "Main Pass");
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, sliceCount > 1 ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+
+    if (sliceCount > 1) {
+        RecordSecondary(commandBuffer, imageIndex, sliceCount, *pipeline, extent);
+    }
+    else {
+        BindDrawState(commandBuffer, *pipeline, extent);
+
+        for (uint32_t item = 0; item < itemCount; item++)
+            RecordDrawItem(commandBuffer, item, true);
+    }
+
+    vkCmdEndRenderPass(commandBuffer);
+    profiler.EndScope(commandBuffer, renderPassScope);
+
+    const std::shared_ptr<Framebuffer>& framebuffer = GetFramebuffer();
+    if (!framebuffer->IsSwapChainTarget() && s_Data.m_ReadbackCallback) {
+        uint32_t readbackScope = profiler.BeginScope(commandBuffer, "Readback");
+        s_Data.m_Readback.Record(commandBuffer, Device::Get().GetCurrentFrame(), framebuffer->GetImage(imageIndex),
+            extent, framebuffer->GetColorFormat(), s_Data.m_FrameIndex);
+        profiler.EndScope(commandBuffer, readbackScope);
+    }
+
+    profiler.EndScope(commandBuffer, frameScope);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record command buffer!");
+    }
+}
+
+void Renderer::PrepareBatches() {
+    const uint32_t currentFrame = Device::Get().GetCurrentFrame();
+    RendererData::QuadBufferPool& pool = s_Data.m_QuadVertexBuffers[currentFrame];
+    std::vector<std::shared_ptr<Buffer>>& vertexBuffers = pool.Buffers;
+    const size_t batchCount = s_Data.m_QuadBatchCounts.size();
+
+    //The slot's fence has been waited on, so its buffers can be released right away
+    if (vertexBuffers.size() > batchCount) {
+        if (++pool.OversizedFrames >= RendererData::QuadBufferTrimFrames) {
+            vertexBuffers.resize(batchCount);
+            pool.OversizedFrames = 0;
+        }
+    }
+    else {
+        pool.OversizedFrames = 0;
+    }
+
+    //Buffers are created up front on the main thread, the uploads happen on whichever thread records the batch
+    while (vertexBuffers.size() < batchCount) {
+        BufferDescription bufferDescription{};
+        bufferDescription.Type = BufferType::VertexBuffer;
+        bufferDescription.MemoryType = BufferMemoryType::PersistentlyMapped;
+        bufferDescription.Size = s_Data.MaxVertices * sizeof(QuadVertex);
+
+        vertexBuffers.push_back(std::make_shared<Buffer>(bufferDescription));
+    }
+
+    while (s_Data.m_BatchScopeNames.size() < s_Data.m_QuadBatchCounts.size())
+        s_Data.m_BatchScopeNames.push_back("Quad Batch " + std::to_string(s_Data.m_BatchScopeNames.size()));
+
+    s_Data.m_Stats.DrawCalls += static_cast<uint32_t>(s_Data.m_QuadBatchCounts.size());
+}
 
-    s_Data.m_Pipeline->Bind(commandBuffer);
+void Renderer::BindDrawState(const VkCommandBuffer commandBuffer, Pipeline& pipeline, VkExtent2D extent) {
+    pipeline.Bind(commandBuffer);
 
     VkViewport viewport{};
     viewport.x = 0.0f;
@@ -184,11 +484,144 @@ void Renderer::RecordCommandBuffer(const VkCommandBuffer commandBuffer, const ui
     scissor.extent = extent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    vkCmdDraw(commandBuffer, static_cast<uint32_t>(s_Data.vertices.size()), 1, 0, 0);
+    s_Data.m_QuadIndexBuffer->Bind(commandBuffer);
+}
 
-    vkCmdEndRenderPass(commandBuffer);
-    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to record command buffer!");
+void Renderer::RecordDrawItem(const VkCommandBuffer commandBuffer, uint32_t item, bool profile) {
+    const uint32_t batchCount = static_cast<uint32_t>(s_Data.m_QuadBatchCounts.size());
+    if (item >= batchCount) {
+        s_Data.m_SceneCommands[item - batchCount](commandBuffer);
+        return;
+    }
+
+    //The frame's fence has been waited on, so nothing on the GPU reads this buffer anymore
+    const uint32_t batch = item;
+    const std::shared_ptr<Buffer>& vertexBuffer = s_Data.m_QuadVertexBuffers[Device::Get().GetCurrentFrame()].Buffers[batch];
+    const uint32_t indexCount = s_Data.m_QuadBatchCounts[batch];
+    const uint32_t vertexCount = indexCount / 6 * 4;
+    vertexBuffer->SetData(&s_Data.m_QuadVertices[batch * s_Data.MaxVertices], vertexCount * sizeof(QuadVertex));
+    vertexBuffer->Bind(commandBuffer);
+
+    //The profiler isn't thread safe, draws in secondary command buffers are only timed as part of the main pass
+    uint32_t batchScope = profile ? s_Data.m_GpuProfiler.BeginScope(commandBuffer, s_Data.m_BatchScopeNames[batch]) : GpuProfiler::NO_SCOPE;
+    RenderCommand::DrawIndexed(indexCount);
+    if (profile)
+        s_Data.m_GpuProfiler.EndScope(commandBuffer, batchScope);
+}
+
+void Renderer::RecordSecondary(const VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t sliceCount, Pipeline& pipeline, VkExtent2D extent) {
+    PROFILE_FUNCTION();
+
+    VkDevice device = Device::Get().GetDevice();
+    std::vector<RendererData::RecordingContext>& contexts = s_Data.m_RecordingContexts[Device::Get().GetCurrentFrame()];
+    const uint32_t itemCount = GetDrawItemCount();
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = pipeline.GetRenderPass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = pipeline.GetFramebuffer(imageIndex);
+
+    std::vector<std::exception_ptr> errors(sliceCount);
+
+    //Contiguous slices executed in slice order keep the draws in submission order
+    auto recordSlice = [&](uint32_t slice) {
+        PROFILE_SCOPE("Renderer::RecordSlice");
+
+        try {
+            RendererData::RecordingContext& context = contexts[slice];
+
+            //The frame's fence has been waited on, whatever the pool recorded last time is done
+            vkResetCommandPool(device, context.CommandPool, 0);
+
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+            if (vkBeginCommandBuffer(context.CommandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording secondary command buffer!");
+            }
+
+            //Secondary command buffers inherit no state from the primary one or each other
+            s_RecordingCommandBuffer = context.CommandBuffer;
+            BindDrawState(context.CommandBuffer, pipeline, extent);
+
+            const uint32_t first = slice * itemCount / sliceCount;
+            const uint32_t last = (slice + 1) * itemCount / sliceCount;
+            for (uint32_t item = first; item < last; item++)
+                RecordDrawItem(context.CommandBuffer, item, false);
+
+            s_RecordingCommandBuffer = VK_NULL_HANDLE;
+
+            if (vkEndCommandBuffer(context.CommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record secondary command buffer!");
+            }
+        }
+        catch (...) {
+            s_RecordingCommandBuffer = VK_NULL_HANDLE;
+            errors[slice] = std::current_exception();
+        }
+    };
+
+    JobCounter counter;
+    for (uint32_t slice = 1; slice < sliceCount; slice++)
+        JobSystem::Get().Run([&recordSlice, slice]() { recordSlice(slice); }, &counter);
+
+    recordSlice(0);
+    JobSystem::Get().Wait(counter);
+
+    for (auto& error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::vector<VkCommandBuffer> secondaryCommandBuffers(sliceCount);
+    for (uint32_t slice = 0; slice < sliceCount; slice++)
+        secondaryCommandBuffers[slice] = contexts[slice].CommandBuffer;
+
+    //No timestamp around this, a subpass recorded from secondaries only allows vkCmdExecuteCommands. "Main Pass" covers it.
+    vkCmdExecuteCommands(commandBuffer, sliceCount, secondaryCommandBuffers.data());
+
+    s_Data.m_Stats.SecondaryCommandBuffers += sliceCount;
+}
+
+void Renderer::SetRecordingThreads(uint32_t threadCount) {
+    //The main thread records a slice as well
+    if (threadCount == 0)
+        threadCount = JobSystem::Get().GetThreadCount() + 1;
+
+    s_Data.m_RecordingThreads = std::clamp(threadCount, 1u, RendererData::MaxRecordingThreads);
+}
+
+void Renderer::CreateRecordingContexts() {
+    VkDevice device = Device::Get().GetDevice();
+    QueueFamilyIndices queueFamilyIndices = Device::Get().GetQueueFamilyIndices();
+
+    s_Data.m_RecordingContexts.resize(Device::MAX_FRAMES_IN_FLIGHT);
+    for (auto& contexts : s_Data.m_RecordingContexts) {
+        contexts.resize(RendererData::MaxRecordingThreads);
+
+        for (auto& context : contexts) {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = queueFamilyIndices.GraphicsFamily.value();
+
+            if (vkCreateCommandPool(device, &poolInfo, nullptr, &context.CommandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create recording command pool!");
+            }
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = context.CommandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(device, &allocInfo, &context.CommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate secondary command buffer!");
+            }
+        }
     }
 }
 
@@ -217,6 +650,8 @@ void Renderer::CreateSyncObjects() {
 }
 
 void Renderer::RecreateSwapchain() {
+    PROFILE_FUNCTION();
+
     //This is in case the window is minimized it will wait until it is restored
     int width = 0, height = 0;
     glfwGetFramebufferSize(Application::Get().GetWindow().GetWindowHandle(), &width, &height);
@@ -225,7 +660,21 @@ void Renderer::RecreateSwapchain() {
         glfwWaitEvents();
     }
 
-    vkDeviceWaitIdle(Device::Get().GetDevice());
+    auto start = std::chrono::high_resolution_clock::now();
+
+    //Compiles still running would read the framebuffer while it changes, their results are rebuilt below if they went stale
+    s_Data.m_PipelineLibrary.WaitIdle();
+
+    //No vkDeviceWaitIdle, frames in flight keep their images and pipelines until the deletion queue releases them
+    GetFramebuffer()->ReCreate();
+
+    s_Data.m_PipelineLibrary.RecreateSwapchain();
+
+    //The quad pipeline doesn't have to come from the library
+    if (s_Data.m_QuadPipeline)
+        s_Data.m_QuadPipeline->RecreateSwapchain();
 
-    s_Data.m_Pipeline->RecreateSwapchain();
+    std::chrono::duration<double, std::milli> recreationTime = std::chrono::high_resolution_clock::now() - start;
+    s_Data.m_Stats.SwapchainRecreations++;
+    s_Data.m_Stats.LastSwapchainRecreationTime = recreationTime.count();
 }
@@ -3,35 +3,114 @@
 
 #include <vulkan/vulkan.h>
 #include <filesystem>
+#include <functional>
+#include <type_traits>
 
 #include <glm/glm.hpp>
 
 #include "VkBuffer.h"
+#include "VkDevice.h"
 #include "VkFrameBuffer.h"
 #include "VkPipeline.h"
+#include "VkPipelineLibrary.h"
 #include "VkShader.h"
+#include "VkReadback.h"
+#include "VkFramePacer.h"
+#include "VkGpuProfiler.h"
+#include "VkBindlessHeap.h"
+#include "VkUniformRingBuffer.h"
+
+#include "Core/JobSystem.h"
 
 struct QuadVertex {
 	glm::vec2 pos;
 	glm::vec3 color;
 };
 
-struct RendererData {
-	const std::vector<QuadVertex> vertices = {
-		{{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-		{{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
-		{{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
-	};
+struct RendererStats {
+	//Of the last scene, reset by BeginScene
+	uint32_t DrawCalls = 0;
+	uint32_t QuadCount = 0;
+
+	//Recorded by the recording threads and executed from the frame's primary command buffer, reset by BeginScene
+	uint32_t SecondaryCommandBuffers = 0;
+
+	//Totals since the last ResetStats
+	//Frames drawn with the default pipeline because the requested one was still compiling
+	uint32_t FallbackFrames = 0;
+
+	uint32_t SwapchainRecreations = 0;
+	double LastSwapchainRecreationTime = 0.0;	//Milliseconds spent on the CPU, the GPU is never waited on
+};
 
+struct RendererData {
 	static const uint32_t MaxQuads = 1000;
 	static const uint32_t MaxVertices = MaxQuads * 4;
 	static const uint32_t MaxIndices = MaxQuads * 6;
 
-	std::unique_ptr<Pipeline> m_Pipeline;
+	PipelineLibrary m_PipelineLibrary;
+
+	//Always compiled up front, stands in for m_QuadPipeline until that one is ready
+	std::shared_ptr<Pipeline> m_Pipeline;
+	std::shared_ptr<Pipeline> m_QuadPipeline;
+
+	//Shared by every batch, the quad pattern never changes
+	std::shared_ptr<Buffer> m_QuadIndexBuffer;
+
+	//Every batch of the scene is MaxVertices long, only the last one may be partially filled
+	std::vector<QuadVertex> m_QuadVertices;
+	std::vector<uint32_t> m_QuadBatchCounts;
+	uint32_t m_QuadIndexCount = 0;
+
+	//Recorded inside the main render pass after the quads, in submission order
+	std::vector<std::function<void(VkCommandBuffer)>> m_SceneCommands;
+
+	//Persistently mapped vertex buffers of one frame slot, reused every time the slot comes around
+	struct QuadBufferPool {
+		std::vector<std::shared_ptr<Buffer>> Buffers;
+
+		//Consecutive frames of this slot that needed fewer buffers than the pool holds
+		uint32_t OversizedFrames = 0;
+	};
+
+	//Buffers beyond what the scene needs are only released once it has needed fewer for this many frames of the slot,
+	//so a batch count that goes up and down doesn't recreate buffers every frame
+	static const uint32_t QuadBufferTrimFrames = 120;
+
+	std::vector<QuadBufferPool> m_QuadVertexBuffers;
+
+	RendererStats m_Stats;
+	FramePacer m_FramePacer;
+	GpuProfiler m_GpuProfiler;
+
+	//Uniform data of the frame being recorded, written by scene commands
+	UniformRingBuffer m_UniformRing;
+
+	//Every texture and storage buffer scenes index by handle, only initialized when the device supports it
+	BindlessHeap m_BindlessHeap;
+	std::vector<std::string> m_BatchScopeNames;
+
+	//Offscreen frames are copied back here when a callback is set
+	FrameReadback m_Readback;
+	ReadbackCallback m_ReadbackCallback;
+	uint64_t m_FrameIndex = 0;
 
 	VkCommandPool m_CommandPool;
 	std::vector<VkCommandBuffer> m_CommandBuffers;
 
+	//Command buffers are only ever touched by one thread at a time, so every slice of the draw list gets its own pool
+	struct RecordingContext {
+		VkCommandPool CommandPool = VK_NULL_HANDLE;
+		VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+	};
+
+	static const uint32_t MaxRecordingThreads = 16;
+	static const uint32_t MinDrawItemsPerSlice = 2;
+
+	//[frame][slice], the main thread records slice 0 and the job system the rest
+	std::vector<std::vector<RecordingContext>> m_RecordingContexts;
+	uint32_t m_RecordingThreads = 1;
+
 	std::vector<VkSemaphore> m_ImageAvailableSemaphores;
 	std::vector<VkSemaphore> m_RenderFinishedSemaphores;
 	std::vector<VkFence> m_InFlightFences;
@@ -42,16 +121,102 @@ public:
 	static void Init();
 	static void Shutdown();
 
+	static void BeginScene();
+	static void EndScene();
+
+	//position is the top left corner in normalized device coordinates
+	static void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec3& color);
+
+	//For anything that isn't a quad, the command binds its own pipeline and buffers. Viewport and scissor are already set.
+	//Commands can be recorded on a recording thread, so they must not touch state that other commands write.
+	static void Submit(std::function<void(VkCommandBuffer)>&& command) { s_Data.m_SceneCommands.push_back(std::move(command)); }
+
+	//Call at the very top of the frame, before input is polled, LowLatency pacing holds the frame back here
+	static void PaceFrame();
 	static void DrawFrame();
+
+	static void SetFramePacing(FramePacing pacing) { s_Data.m_FramePacer.SetMode(pacing); }
+	static FramePacing GetFramePacing() { return s_Data.m_FramePacer.GetMode(); }
+	static const FrameTiming& GetFrameTiming() { return s_Data.m_FramePacer.GetTiming(); }
+
+	//Waits for the device to go idle, so only call this when switching modes, not every frame
+	static void SetFramesInFlight(uint32_t framesInFlight);
+
+	//Threads recording the draw list into secondary command buffers, including the main thread. 1 records everything
+	//inline on the main thread, 0 picks one per job system thread. Don't call while a frame is being recorded.
+	static void SetRecordingThreads(uint32_t threadCount);
+	static uint32_t GetRecordingThreads() { return s_Data.m_RecordingThreads; }
+
+	//Recreate the swapchain without waiting for the GPU. Nothing happens when rendering offscreen.
+	static void SetPresentMode(PresentMode presentMode);
+	static void SetSwapChainImageCount(uint32_t imageCount);
+	static VkPresentModeKHR GetPresentMode() { return GetFramebuffer()->GetPresentMode(); }
+
+	static const std::shared_ptr<Framebuffer>& GetFramebuffer() { return s_Data.m_Pipeline->GetDescription().Framebuffer; }
+
+	//Shared with every other user of an identical description
+	static std::shared_ptr<Pipeline> GetPipeline(const PipelineDescription& description) { return s_Data.m_PipelineLibrary.GetPipeline(description); }
+	static std::shared_ptr<Pipeline> GetPipelineAsync(const PipelineDescription& description) { return s_Data.m_PipelineLibrary.GetPipelineAsync(description); }
+
+	//Records data into the push constants of the bound pipeline, which has to be layout compatible with pipeline.
+	//stages defaults to the stages of every range the data overlaps. Every byte has to be covered by ranges of exactly
+	//those stages, data spanning ranges of different stages has to be pushed in parts.
+	template<typename T>
+	static void PushConstants(const Pipeline& pipeline, const T& data, uint32_t offset = 0, VkShaderStageFlags stages = 0) {
+		static_assert(sizeof(T) <= Pipeline::MIN_PUSH_CONSTANTS_SIZE, "push constants are larger than every device is guaranteed to support!");
+		static_assert(sizeof(T) % 4 == 0, "push constants have to be a multiple of 4 bytes!");
+		static_assert(std::is_trivially_copyable_v<T>, "push constants are copied as raw bytes!");
+
+		if (stages == 0)
+			stages = pipeline.GetPushConstantStages(offset, sizeof(T));
+		pipeline.ValidatePushConstants(offset, sizeof(T), stages);
+
+		vkCmdPushConstants(GetCurrentCommandBuffer(), pipeline.GetLayout(), stages, offset, sizeof(T), &data);
+	}
+
+	//Quads are drawn with this pipeline once it has finished compiling, nullptr goes back to the default one.
+	//It has to take the QuadVertex layout and render into the swapchain framebuffer.
+	static void SetQuadPipeline(const std::shared_ptr<Pipeline>& pipeline) { s_Data.m_QuadPipeline = pipeline; }
+
+	//Only valid while a frame is being recorded, on a recording thread this is the secondary command buffer it records into
+	static VkCommandBuffer GetCurrentCommandBuffer() {
+		return s_RecordingCommandBuffer != VK_NULL_HANDLE ? s_RecordingCommandBuffer : s_Data.m_CommandBuffers[Device::Get().GetCurrentFrame()];
+	}
+
+	//Called with every finished frame of an offscreen framebuffer, one or more frames after it was drawn.
+	//Has no effect when rendering to a swapchain.
+	static void SetReadbackCallback(const ReadbackCallback& callback) { s_Data.m_ReadbackCallback = callback; }
+
+	//GPU time of the frame, the main render pass, every quad batch and the readback copy
+	static GpuProfiler& GetGpuProfiler() { return s_Data.m_GpuProfiler; }
+	static UniformRingBuffer& GetUniformRing() { return s_Data.m_UniformRing; }
+	static BindlessHeap& GetBindlessHeap() { return s_Data.m_BindlessHeap; }
+
+	static const RendererStats& GetStats() { return s_Data.m_Stats; }
+	static void ResetStats() { s_Data.m_Stats = {}; }
 private:
+	static void NextBatch();
+
+	//The draw list is every quad batch followed by every submitted scene command
+	static uint32_t GetDrawItemCount() { return static_cast<uint32_t>(s_Data.m_QuadBatchCounts.size() + s_Data.m_SceneCommands.size()); }
+	static void PrepareBatches();
+	static void BindDrawState(const VkCommandBuffer commandBuffer, Pipeline& pipeline, VkExtent2D extent);
+	static void RecordDrawItem(const VkCommandBuffer commandBuffer, uint32_t item, bool profile);
+	static void RecordSecondary(const VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t sliceCount, Pipeline& pipeline, VkExtent2D extent);
+
 	static void CreateCommandPool();
 	static void CreateCommandBuffer();
+	static void CreateRecordingContexts();
 	static void RecordCommandBuffer(const VkCommandBuffer commandBuffer, const uint32_t imageIndex);
 
+	//Leaves the frame slot usable after recording threw, the frame is dropped
+	static void AbandonFrame(uint32_t currentFrame, bool headless);
+
 	static void CreateSyncObjects();
 
 	static void RecreateSwapchain();
 private:
 	inline static RendererData s_Data;
+	inline static thread_local VkCommandBuffer s_RecordingCommandBuffer = VK_NULL_HANDLE;
 };
 
@@ -1,9 +1,23 @@
 #include "VkRendererAPI.h"
 
+#include "VkRenderer.h"
+
 void RendererAPI::Init() {
 
 }
 
-void RendererAPI::Draw(const std::shared_ptr<Framebuffer> frameBuffer, uint32_t count) {
+void RendererAPI::Draw(uint32_t vertexCount, uint32_t firstVertex) {
+    vkCmdDraw(Renderer::GetCurrentCommandBuffer(), vertexCount, 1, firstVertex, 0);
+}
+
+void RendererAPI::DrawIndexed(uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset) {
+    vkCmdDrawIndexed(Renderer::GetCurrentCommandBuffer(), indexCount, 1, firstIndex, vertexOffset, 0);
+}
+
+void RendererAPI::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+    vkCmdDraw(Renderer::GetCurrentCommandBuffer(), vertexCount, instanceCount, firstVertex, firstInstance);
+}
 
+void RendererAPI::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    vkCmdDrawIndexed(Renderer::GetCurrentCommandBuffer(), indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
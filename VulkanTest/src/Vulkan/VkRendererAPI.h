@@ -13,8 +13,13 @@ public:
 	void SetClearColor(const glm::vec4& color) { m_ClearColor = color; }
 	const glm::vec4& GetClearColor() const { return m_ClearColor; }
 
-	void Draw(const std::shared_ptr<Framebuffer> frameBuffer, uint32_t count);
-	void DrawIndexed(const std::shared_ptr<Framebuffer> frameBuffer, uint32_t indexCount);
+	//Recorded into the command buffer of the frame currently being recorded
+	void Draw(uint32_t vertexCount, uint32_t firstVertex = 0);
+	void DrawIndexed(uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0);
+
+	//Per instance vertex buffers have to be bound to the pipeline's instanced bindings first
+	void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+	void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
 private:
 	glm::vec4 m_ClearColor;
 };
@@ -0,0 +1,110 @@
+#include "VkSamplerCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Core/Hash.h"
+
+static VkFilter GetVkFilter(TextureFilter filter) {
+    switch (filter) {
+        case TextureFilter::Nearest:    return VK_FILTER_NEAREST;
+        case TextureFilter::Linear:     return VK_FILTER_LINEAR;
+    }
+
+    throw std::runtime_error("TextureFilter not supported");
+}
+
+static VkSamplerAddressMode GetVkAddressMode(TextureWrap wrap) {
+    switch (wrap) {
+        case TextureWrap::Repeat:           return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        case TextureWrap::MirroredRepeat:   return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+        case TextureWrap::ClampToEdge:      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        case TextureWrap::ClampToBorder:    return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+    }
+
+    throw std::runtime_error("TextureWrap not supported");
+}
+
+void SamplerCache::Init(VkDevice device, VkPhysicalDevice physicalDevice) {
+    m_Device = device;
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    //Device::CreateLogicalDevice enables samplerAnisotropy whenever it is supported
+    m_MaxAnisotropy = features.samplerAnisotropy ? properties.limits.maxSamplerAnisotropy : 1.0f;
+}
+
+void SamplerCache::Shutdown() {
+    for (auto& [hash, entries] : m_Samplers) {
+        for (auto& entry : entries)
+            vkDestroySampler(m_Device, entry.Sampler, nullptr);
+    }
+
+    m_Samplers.clear();
+}
+
+VkSampler SamplerCache::GetSampler(const SamplerDescription& description) {
+    uint64_t hash = HashValue(description.MinFilter);
+    hash = HashValue(description.MagFilter, hash);
+    hash = HashValue(description.MipFilter, hash);
+    hash = HashValue(description.Wrap, hash);
+    hash = HashValue(description.MaxAnisotropy, hash);
+    hash = HashValue(description.MaxLod, hash);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    std::vector<Entry>& entries = m_Samplers[hash];
+    for (const auto& entry : entries) {
+        if (entry.Description == description)
+            return entry.Sampler;
+    }
+
+    VkSampler sampler = CreateSampler(description);
+    entries.push_back({ description, sampler });
+
+    return sampler;
+}
+
+uint32_t SamplerCache::GetSamplerCount() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    uint32_t count = 0;
+    for (const auto& [hash, entries] : m_Samplers)
+        count += static_cast<uint32_t>(entries.size());
+
+    return count;
+}
+
+VkSampler SamplerCache::CreateSampler(const SamplerDescription& description) {
+    VkSamplerAddressMode addressMode = GetVkAddressMode(description.Wrap);
+    float maxAnisotropy = (std::min)(description.MaxAnisotropy, m_MaxAnisotropy);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = GetVkFilter(description.MagFilter);
+    samplerInfo.minFilter = GetVkFilter(description.MinFilter);
+    samplerInfo.mipmapMode = description.MipFilter == TextureFilter::Linear ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = addressMode;
+    samplerInfo.addressModeV = addressMode;
+    samplerInfo.addressModeW = addressMode;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+    samplerInfo.maxAnisotropy = (std::max)(maxAnisotropy, 1.0f);
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = description.MaxLod;
+    samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+    VkSampler sampler;
+    if (vkCreateSampler(m_Device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+
+    return sampler;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+enum class TextureFilter {
+	Nearest,
+	Linear
+};
+
+enum class TextureWrap {
+	Repeat,
+	MirroredRepeat,
+	ClampToEdge,
+	ClampToBorder	//Transparent black outside the texture
+};
+
+struct SamplerDescription {
+	TextureFilter MinFilter = TextureFilter::Linear;
+	TextureFilter MagFilter = TextureFilter::Linear;
+	TextureFilter MipFilter = TextureFilter::Linear;
+	TextureWrap Wrap = TextureWrap::Repeat;
+
+	//Clamped to the device limit, 1 or less turns anisotropic filtering off
+	float MaxAnisotropy = 16.0f;
+
+	//Only the mip levels up to MaxLod are sampled, 0 turns mipmapping off
+	float MaxLod = VK_LOD_CLAMP_NONE;
+
+	bool operator==(const SamplerDescription& other) const {
+		return MinFilter == other.MinFilter && MagFilter == other.MagFilter && MipFilter == other.MipFilter && Wrap == other.Wrap &&
+			MaxAnisotropy == other.MaxAnisotropy && MaxLod == other.MaxLod;
+	}
+};
+
+//Samplers only depend on their state, so every texture sampled the same way shares one. Devices may limit the number
+//of samplers alive at once to as little as 4000, a texture owning its own would run into that long before memory does.
+class SamplerCache {
+public:
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice);
+	void Shutdown();
+
+	//Created the first time a description is asked for, lives until Shutdown
+	VkSampler GetSampler(const SamplerDescription& description);
+
+	uint32_t GetSamplerCount();
+private:
+	VkSampler CreateSampler(const SamplerDescription& description);
+private:
+	struct Entry {
+		SamplerDescription Description;
+		VkSampler Sampler;
+	};
+
+	VkDevice m_Device = VK_NULL_HANDLE;
+	float m_MaxAnisotropy = 1.0f;
+
+	std::unordered_map<uint64_t, std::vector<Entry>> m_Samplers;
+	std::mutex m_Mutex;
+};
@@ -1,15 +1,22 @@
 #include "VkShader.h"
 
 #include "VkDevice.h"
+#include "Core/Hash.h"
+#include "Core/Instrumentor.h"
 
 #include <fstream>
 
 Shader::Shader(std::filesystem::path& vertexShader, std::filesystem::path& fragmentShader) {
+    PROFILE_FUNCTION();
+
     auto vertShaderCode = ReadFile(vertexShader);
     auto fragShaderCode = ReadFile(fragmentShader);
 
     m_VertexShaderModule = CreateShaderModule(vertShaderCode);
     m_FragmentShaderModule = CreateShaderModule(fragShaderCode);
+
+    m_Hash = HashBytes(vertShaderCode.data(), vertShaderCode.size());
+    m_Hash = HashBytes(fragShaderCode.data(), fragShaderCode.size(), m_Hash);
 }
 
 Shader::~Shader() {
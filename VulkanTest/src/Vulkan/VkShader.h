@@ -10,10 +10,15 @@ public:
 	~Shader();
 
 	std::vector<VkPipelineShaderStageCreateInfo> GetShaderStages() const;
+
+	//Hash of the SPIR-V code, two shaders loaded from the same files hash the same
+	uint64_t GetHash() const { return m_Hash; }
 private:
 	VkShaderModule CreateShaderModule(const std::vector<char>& code);
 	std::vector<char> ReadFile(const std::filesystem::path& filename);
 private:
 	VkShaderModule m_VertexShaderModule;
 	VkShaderModule m_FragmentShaderModule;
+
+	uint64_t m_Hash;
 };
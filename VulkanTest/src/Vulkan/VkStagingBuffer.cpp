@@ -0,0 +1,244 @@
+#include "VkStagingBuffer.h"
+
+#include "VkDevice.h"
+#include "Core/Instrumentor.h"
+
+#include <cstring>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void StagingBuffer::Init(VkDeviceSize size) {
+    VkDevice device = Device::Get().GetDevice();
+    m_Size = size;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_Size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &m_Buffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, m_Buffer, &memRequirements);
+
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    m_Allocation = allocator.Allocate(memRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vkBindBufferMemory(device, m_Buffer, m_Allocation.Memory, m_Allocation.Offset);
+
+    //Stays mapped for the lifetime of the ring
+    m_MappedData = static_cast<char*>(allocator.Map(m_Allocation));
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = Device::Get().GetQueueFamilyIndices().GraphicsFamily.value();
+
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging command pool!");
+    }
+}
+
+void StagingBuffer::Shutdown() {
+    VkDevice device = Device::Get().GetDevice();
+    WaitIdle();
+
+    for (auto& batch : m_Batches) {
+        vkDestroyFence(device, batch.Fence, nullptr);
+    }
+    m_Batches.clear();
+    m_FreeBatches.clear();
+
+    vkDestroyCommandPool(device, m_CommandPool, nullptr);
+
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    allocator.Unmap(m_Allocation);
+    vkDestroyBuffer(device, m_Buffer, nullptr);
+    allocator.Free(m_Allocation);
+}
+
+StagingAllocation StagingBuffer::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    if (size > m_Size) {
+        throw std::runtime_error("staging allocation is larger than the staging buffer!");
+    }
+
+    //Allocations never straddle the end of the ring, they skip ahead to the start instead
+    uint64_t position = AlignUp(m_Head, alignment);
+    if (position % m_Size + size > m_Size)
+        position = AlignUp(position, m_Size);
+
+    RetireBatches(false);
+    while (position + size - m_Tail > m_Size) {
+        if (m_InFlightBatches.empty() && m_CurrentBatch == NO_BATCH) {
+            //Nothing is using the ring anymore, start over at its beginning
+            position = AlignUp(m_Head, m_Size);
+            m_Head = m_Tail = position;
+            break;
+        }
+
+        //The batch being recorded owns the space we need, it has to be submitted before it can be waited on
+        if (m_InFlightBatches.empty())
+            Flush();
+
+        RetireBatches(true);
+    }
+
+    m_Head = position + size;
+
+    StagingAllocation allocation{};
+    allocation.Buffer = m_Buffer;
+    allocation.Offset = position % m_Size;
+    allocation.MappedData = m_MappedData + allocation.Offset;
+
+    return allocation;
+}
+
+VkCommandBuffer StagingBuffer::GetCommandBuffer() {
+    if (m_CurrentBatch == NO_BATCH)
+        m_CurrentBatch = AcquireBatch();
+
+    return m_Batches[m_CurrentBatch].CommandBuffer;
+}
+
+void StagingBuffer::UploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    //Uploads bigger than half the ring are split up so they don't have to wait for the whole ring to drain
+    const VkDeviceSize maxChunkSize = m_Size / 2;
+
+    VkDeviceSize uploaded = 0;
+    while (uploaded < size) {
+        VkDeviceSize chunkSize = (std::min)(size - uploaded, maxChunkSize);
+
+        StagingAllocation staging = Allocate(chunkSize);
+        memcpy(staging.MappedData, static_cast<const char*>(data) + uploaded, chunkSize);
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = staging.Offset;
+        copyRegion.dstOffset = dstOffset + uploaded;
+        copyRegion.size = chunkSize;
+        vkCmdCopyBuffer(GetCommandBuffer(), staging.Buffer, dstBuffer, 1, &copyRegion);
+
+        uploaded += chunkSize;
+    }
+}
+
+void StagingBuffer::Flush() {
+    PROFILE_FUNCTION();
+
+    if (m_CurrentBatch == NO_BATCH)
+        return;
+
+    Batch& batch = m_Batches[m_CurrentBatch];
+
+    //Make the copies visible to everything that reads vertex, index, uniform or shader data afterwards
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(batch.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(batch.CommandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record staging command buffer!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.CommandBuffer;
+
+    if (vkQueueSubmit(Device::Get().GetGraphicsQueue(), 1, &submitInfo, batch.Fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit staging command buffer!");
+    }
+
+    batch.End = m_Head;
+    m_InFlightBatches.push_back(m_CurrentBatch);
+    m_CurrentBatch = NO_BATCH;
+
+    RetireBatches(false);
+}
+
+void StagingBuffer::WaitIdle() {
+    Flush();
+
+    while (!m_InFlightBatches.empty())
+        RetireBatches(true);
+}
+
+uint32_t StagingBuffer::AcquireBatch() {
+    VkDevice device = Device::Get().GetDevice();
+
+    uint32_t index;
+    if (!m_FreeBatches.empty()) {
+        index = m_FreeBatches.back();
+        m_FreeBatches.pop_back();
+    }
+    else {
+        Batch batch{};
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = m_CommandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(device, &allocInfo, &batch.CommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate staging command buffer!");
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(device, &fenceInfo, nullptr, &batch.Fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create staging fence!");
+        }
+
+        index = static_cast<uint32_t>(m_Batches.size());
+        m_Batches.push_back(batch);
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(m_Batches[index].CommandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording staging command buffer!");
+    }
+
+    //Copies must not overwrite data that earlier submissions are still reading
+    vkCmdPipelineBarrier(m_Batches[index].CommandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    return index;
+}
+
+void StagingBuffer::RetireBatches(bool wait) {
+    VkDevice device = Device::Get().GetDevice();
+
+    while (!m_InFlightBatches.empty()) {
+        uint32_t index = m_InFlightBatches.front();
+        Batch& batch = m_Batches[index];
+
+        if (wait) {
+            vkWaitForFences(device, 1, &batch.Fence, VK_TRUE, UINT64_MAX);
+            wait = false;
+        }
+        else if (vkGetFenceStatus(device, batch.Fence) != VK_SUCCESS) {
+            break;
+        }
+
+        vkResetFences(device, 1, &batch.Fence);
+        m_Tail = batch.End;
+
+        m_FreeBatches.push_back(index);
+        m_InFlightBatches.pop_front();
+    }
+
+    if (m_InFlightBatches.empty() && m_CurrentBatch == NO_BATCH)
+        m_Tail = m_Head;
+}
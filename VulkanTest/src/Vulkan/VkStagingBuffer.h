@@ -0,0 +1,67 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+
+#include "VkMemoryAllocator.h"
+
+struct StagingAllocation {
+	VkBuffer Buffer;
+	VkDeviceSize Offset;
+	void* MappedData;
+};
+
+//Host visible ring buffer that uploads to device local resources are copied through.
+//Copies are recorded into a batch command buffer that is submitted on Flush, and the ring space of a batch
+//is only handed out again once that batch's fence has signaled.
+class StagingBuffer {
+public:
+	void Init(VkDeviceSize size = DEFAULT_SIZE);
+	void Shutdown();
+
+	//Reserves space in the ring, submitting and waiting on older batches if the ring is full
+	StagingAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 4);
+
+	//The command buffer of the batch currently being recorded, copies out of an allocation must be recorded here
+	VkCommandBuffer GetCommandBuffer();
+
+	void UploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+	//Submits everything recorded since the last flush on the graphics queue
+	void Flush();
+	void WaitIdle();
+
+	VkDeviceSize GetSize() const { return m_Size; }
+public:
+	static const VkDeviceSize DEFAULT_SIZE = 32ull * 1024 * 1024;
+private:
+	struct Batch {
+		VkCommandBuffer CommandBuffer;
+		VkFence Fence;
+
+		//Virtual ring position up to which this batch's data reaches
+		uint64_t End;
+	};
+
+	uint32_t AcquireBatch();
+	void RetireBatches(bool wait);
+private:
+	VkBuffer m_Buffer = VK_NULL_HANDLE;
+	MemoryAllocation m_Allocation;
+	char* m_MappedData = nullptr;
+
+	VkDeviceSize m_Size = 0;
+
+	//Positions only ever grow, the physical offset is position % m_Size
+	uint64_t m_Head = 0;
+	uint64_t m_Tail = 0;
+
+	VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+	std::vector<Batch> m_Batches;
+	std::vector<uint32_t> m_FreeBatches;
+	std::deque<uint32_t> m_InFlightBatches;
+
+	static const uint32_t NO_BATCH = ~0u;
+	uint32_t m_CurrentBatch = NO_BATCH;
+};
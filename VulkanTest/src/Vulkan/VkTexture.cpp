@@ -0,0 +1,286 @@
+#include "VkTexture.h"
+
+#include "VkDevice.h"
+#include "Core/Instrumentor.h"
+
+#include <algorithm>
+#include <cstring>
+
+//Everything in a texture is read by shaders once uploaded
+static const VkPipelineStageFlags SHADER_STAGES = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+Texture::Texture(const TextureDescription& description)
+    : m_Description(description) {
+    PROFILE_FUNCTION();
+
+    VkDevice device = Device::Get().GetDevice();
+    VkFormat format = GetVkTextureFormat(m_Description.Format);
+
+    if (m_Description.Width == 0 || m_Description.Height == 0) {
+        throw std::runtime_error("texture must be at least 1x1!");
+    }
+
+    if (!IsFormatSupported(m_Description.Format)) {
+        throw std::runtime_error("texture format is not supported by the device!");
+    }
+
+    if (m_Description.GenerateMips) {
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(Device::Get().GetPhysicalDevice(), format, &formatProperties);
+
+        //Each level is blitted from the one above with a linear filter
+        const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        //Otherwise the texture keeps a single level
+        if ((formatProperties.optimalTilingFeatures & required) == required)
+            m_MipLevels = CalculateMipLevels(m_Description.Width, m_Description.Height);
+    }
+    else {
+        m_MipLevels = (std::min)((std::max)(m_Description.MipLevels, 1u), CalculateMipLevels(m_Description.Width, m_Description.Height));
+    }
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = m_Description.Width;
+    imageInfo.extent.height = m_Description.Height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = m_MipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    //Blit sources
+    if (m_Description.GenerateMips && m_MipLevels > 1)
+        imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+    if (vkCreateImage(device, &imageInfo, nullptr, &m_Image) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture image!");
+    }
+
+    //The destructor doesn't run when the constructor throws, and nothing has been submitted that could still use these
+    MemoryAllocator& allocator = Device::Get().GetAllocator();
+    try {
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, m_Image, &memRequirements);
+
+        m_Allocation = allocator.Allocate(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryResourceType::Optimal);
+        if (vkBindImageMemory(device, m_Image, m_Allocation.Memory, m_Allocation.Offset) != VK_SUCCESS) {
+            throw std::runtime_error("failed to bind texture image memory!");
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = m_Image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = m_MipLevels;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &m_ImageView) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture image view!");
+        }
+
+        m_Sampler = Device::Get().GetSamplerCache().GetSampler(m_Description.Sampler);
+    }
+    catch (...) {
+        if (m_ImageView != VK_NULL_HANDLE)
+            vkDestroyImageView(device, m_ImageView, nullptr);
+        if (m_Allocation.IsValid())
+            allocator.Free(m_Allocation);
+        vkDestroyImage(device, m_Image, nullptr);
+        throw;
+    }
+}
+
+Texture::~Texture() {
+    //Frames in flight may still sample the texture, the sampler belongs to the cache
+    VkImage image = m_Image;
+    VkImageView imageView = m_ImageView;
+    MemoryAllocation allocation = m_Allocation;
+
+    Device::Get().GetDeletionQueue().Push([image, imageView, allocation]() mutable {
+        VkDevice device = Device::Get().GetDevice();
+        vkDestroyImageView(device, imageView, nullptr);
+        vkDestroyImage(device, image, nullptr);
+        Device::Get().GetAllocator().Free(allocation);
+    });
+}
+
+void Texture::SetData(const void* data, uint64_t size) {
+    PROFILE_FUNCTION();
+
+    StagingBuffer& staging = Device::Get().GetStagingBuffer();
+
+    //The previous contents are discarded, earlier frames only need to be done reading them
+    TransitionLevels(staging.GetCommandBuffer(), 0, m_MipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT, SHADER_STAGES, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    CopyLevel(0, data, size);
+
+    if (m_MipLevels > 1 && m_Description.GenerateMips) {
+        RecordMipGeneration(staging.GetCommandBuffer());
+        return;
+    }
+
+    //Levels below 0 keep undefined contents until SetLevels fills them
+    TransitionLevels(staging.GetCommandBuffer(), 0, m_MipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_STAGES);
+}
+
+void Texture::SetLevels(const TextureLevelData* levels, uint32_t levelCount) {
+    PROFILE_FUNCTION();
+
+    if (levelCount != m_MipLevels) {
+        throw std::runtime_error("texture data must cover every mip level!");
+    }
+
+    StagingBuffer& staging = Device::Get().GetStagingBuffer();
+
+    TransitionLevels(staging.GetCommandBuffer(), 0, m_MipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        0, VK_ACCESS_TRANSFER_WRITE_BIT, SHADER_STAGES, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    for (uint32_t level = 0; level < levelCount; level++)
+        CopyLevel(level, levels[level].Data, levels[level].Size);
+
+    TransitionLevels(staging.GetCommandBuffer(), 0, m_MipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_STAGES);
+}
+
+uint32_t Texture::CalculateMipLevels(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    for (uint32_t size = (std::max)(width, height); size > 1; size /= 2)
+        levels++;
+
+    return levels;
+}
+
+uint64_t Texture::CalculateLevelSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t level) {
+    const uint32_t blockDimension = GetTextureFormatBlockDimension(format);
+    const uint64_t blocksWide = ((std::max)(width >> level, 1u) + blockDimension - 1) / blockDimension;
+    const uint64_t blocksHigh = ((std::max)(height >> level, 1u) + blockDimension - 1) / blockDimension;
+
+    return blocksWide * blocksHigh * GetTextureFormatSize(format);
+}
+
+bool Texture::IsFormatSupported(TextureFormat format) {
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(Device::Get().GetPhysicalDevice(), GetVkTextureFormat(format), &formatProperties);
+
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & required) == required;
+}
+
+void Texture::CopyLevel(uint32_t level, const void* data, uint64_t size) {
+    const TextureFormat format = m_Description.Format;
+    const uint32_t blockDimension = GetTextureFormatBlockDimension(format);
+    const uint32_t blockSize = GetTextureFormatSize(format);
+
+    const uint32_t width = (std::max)(m_Description.Width >> level, 1u);
+    const uint32_t height = (std::max)(m_Description.Height >> level, 1u);
+    const uint32_t blockRows = (height + blockDimension - 1) / blockDimension;
+    const uint64_t rowPitch = static_cast<uint64_t>((width + blockDimension - 1) / blockDimension) * blockSize;
+
+    if (size != rowPitch * blockRows) {
+        throw std::runtime_error("texture data must cover the whole mip level!");
+    }
+
+    StagingBuffer& staging = Device::Get().GetStagingBuffer();
+
+    //Copied in bands of whole rows so large textures don't have to wait for the whole ring to drain, like UploadBuffer.
+    //Buffer offsets have to be a multiple of the block size and of 4.
+    const uint32_t rowsPerCopy = static_cast<uint32_t>((std::max)(staging.GetSize() / 2 / rowPitch, (VkDeviceSize)1));
+    const VkDeviceSize alignment = (std::max)(blockSize, 4u);
+
+    for (uint32_t row = 0; row < blockRows; row += rowsPerCopy) {
+        uint32_t rowCount = (std::min)(rowsPerCopy, blockRows - row);
+        VkDeviceSize copySize = rowPitch * rowCount;
+
+        StagingAllocation allocation = staging.Allocate(copySize, alignment);
+        memcpy(allocation.MappedData, static_cast<const char*>(data) + rowPitch * row, copySize);
+
+        //The extent may end inside the last blocks, but only at the edge of the level
+        const uint32_t texelRow = row * blockDimension;
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = allocation.Offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, static_cast<int32_t>(texelRow), 0 };
+        region.imageExtent = { width, (std::min)(rowCount * blockDimension, height - texelRow), 1 };
+
+        //Fetched after Allocate, which may have submitted the batch the earlier copies went into
+        vkCmdCopyBufferToImage(staging.GetCommandBuffer(), allocation.Buffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+}
+
+void Texture::RecordMipGeneration(VkCommandBuffer commandBuffer) {
+    int32_t width = static_cast<int32_t>(m_Description.Width);
+    int32_t height = static_cast<int32_t>(m_Description.Height);
+
+    //Every level is still in TRANSFER_DST, each one becomes the blit source of the next once it has been written
+    for (uint32_t level = 1; level < m_MipLevels; level++) {
+        TransitionLevels(commandBuffer, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+        int32_t mipWidth = (std::max)(width / 2, 1);
+        int32_t mipHeight = (std::max)(height / 2, 1);
+
+        VkImageBlit blit{};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.srcOffsets[0] = { 0, 0, 0 };
+        blit.srcOffsets[1] = { width, height, 1 };
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+        blit.dstOffsets[0] = { 0, 0, 0 };
+        blit.dstOffsets[1] = { mipWidth, mipHeight, 1 };
+
+        vkCmdBlitImage(commandBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        //Done as a source, nothing writes to it anymore
+        TransitionLevels(commandBuffer, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_STAGES);
+
+        width = mipWidth;
+        height = mipHeight;
+    }
+
+    //The smallest level is only ever written
+    TransitionLevels(commandBuffer, m_MipLevels - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, SHADER_STAGES);
+}
+
+void Texture::TransitionLevels(VkCommandBuffer commandBuffer, uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_Image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = baseLevel;
+    barrier.subresourceRange.levelCount = levelCount;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
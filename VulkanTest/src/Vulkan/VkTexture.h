@@ -0,0 +1,151 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <stdexcept>
+
+#include "VkMemoryAllocator.h"
+#include "VkSamplerCache.h"
+
+enum class TextureFormat {
+	RGBA8,
+	RGBA8_SRGB,
+	R8,
+	RG8,
+	RGBA16F,
+
+	//Block compressed, 4x4 texels per block
+	BC1,			//RGB with 1 bit alpha, 8 bytes per block
+	BC1_SRGB,
+	BC1_RGB,		//Same blocks as BC1, alpha always reads as 1
+	BC1_RGB_SRGB,
+	BC3,			//RGBA, 16 bytes per block
+	BC3_SRGB,
+	BC5,			//Two channels, normal maps
+	BC5_SNORM,
+	BC7,			//High quality RGBA, 16 bytes per block
+	BC7_SRGB
+};
+
+static VkFormat GetVkTextureFormat(TextureFormat format) {
+	switch (format) {
+		case TextureFormat::RGBA8:		return VK_FORMAT_R8G8B8A8_UNORM;
+		case TextureFormat::RGBA8_SRGB:	return VK_FORMAT_R8G8B8A8_SRGB;
+		case TextureFormat::R8:			return VK_FORMAT_R8_UNORM;
+		case TextureFormat::RG8:		return VK_FORMAT_R8G8_UNORM;
+		case TextureFormat::RGBA16F:	return VK_FORMAT_R16G16B16A16_SFLOAT;
+		case TextureFormat::BC1:		return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case TextureFormat::BC1_SRGB:	return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case TextureFormat::BC1_RGB:	return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case TextureFormat::BC1_RGB_SRGB:	return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		case TextureFormat::BC3:		return VK_FORMAT_BC3_UNORM_BLOCK;
+		case TextureFormat::BC3_SRGB:	return VK_FORMAT_BC3_SRGB_BLOCK;
+		case TextureFormat::BC5:		return VK_FORMAT_BC5_UNORM_BLOCK;
+		case TextureFormat::BC5_SNORM:	return VK_FORMAT_BC5_SNORM_BLOCK;
+		case TextureFormat::BC7:		return VK_FORMAT_BC7_UNORM_BLOCK;
+		case TextureFormat::BC7_SRGB:	return VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+
+	throw std::runtime_error("TextureFormat not supported");
+}
+
+static bool IsCompressedTextureFormat(TextureFormat format) {
+	return format >= TextureFormat::BC1;
+}
+
+//Texels along each side of a block, 1 for uncompressed formats
+static uint32_t GetTextureFormatBlockDimension(TextureFormat format) {
+	return IsCompressedTextureFormat(format) ? 4 : 1;
+}
+
+//Bytes per block, which is a single texel for uncompressed formats
+static uint32_t GetTextureFormatSize(TextureFormat format) {
+	switch (format) {
+		case TextureFormat::RGBA8:		return 4;
+		case TextureFormat::RGBA8_SRGB:	return 4;
+		case TextureFormat::R8:			return 1;
+		case TextureFormat::RG8:		return 2;
+		case TextureFormat::RGBA16F:	return 8;
+		case TextureFormat::BC1:
+		case TextureFormat::BC1_SRGB:
+		case TextureFormat::BC1_RGB:
+		case TextureFormat::BC1_RGB_SRGB:	return 8;
+		case TextureFormat::BC3:
+		case TextureFormat::BC3_SRGB:
+		case TextureFormat::BC5:
+		case TextureFormat::BC5_SNORM:
+		case TextureFormat::BC7:
+		case TextureFormat::BC7_SRGB:	return 16;
+	}
+
+	throw std::runtime_error("TextureFormat not supported");
+}
+
+//One mip level's data, tightly packed rows of texels or blocks
+struct TextureLevelData {
+	const void* Data = nullptr;
+	uint64_t Size = 0;
+};
+
+struct TextureDescription {
+	uint32_t Width, Height;
+	TextureFormat Format = TextureFormat::RGBA8;
+
+	//Fills the whole mip chain from level 0 on every SetData, skipped when the format can't be blitted with linear filtering,
+	//which includes every compressed format
+	bool GenerateMips = true;
+
+	//Levels the image is created with when mips aren't generated, filled with SetLevels
+	uint32_t MipLevels = 1;
+
+	//The sampler comes from the device's sampler cache, textures with the same description share it
+	SamplerDescription Sampler;
+};
+
+//Device local, optimal tiling 2D texture. Data goes through the device's staging buffer, the copy, mip generation and
+//layout transitions are recorded into the staging batch, which the renderer submits before the next frame. Between
+//uploads the whole image is in SHADER_READ_ONLY_OPTIMAL.
+class Texture {
+public:
+	Texture(const TextureDescription& description);
+	~Texture();
+
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+
+	//size must be Width * Height * the format's texel size, tightly packed rows
+	void SetData(const void* data, uint64_t size);
+
+	//Every level at once, largest first, e.g. precompressed mip chains. Copied straight from data into the staging buffer.
+	void SetLevels(const TextureLevelData* levels, uint32_t levelCount);
+
+	const TextureDescription& GetDescription() const { return m_Description; }
+	uint32_t GetWidth() const { return m_Description.Width; }
+	uint32_t GetHeight() const { return m_Description.Height; }
+	uint32_t GetMipLevels() const { return m_MipLevels; }
+
+	VkImage GetImage() const { return m_Image; }
+	VkImageView GetImageView() const { return m_ImageView; }
+	VkSampler GetSampler() const { return m_Sampler; }
+
+	//Full chain down to 1x1
+	static uint32_t CalculateMipLevels(uint32_t width, uint32_t height);
+
+	//Tightly packed size of a level, in whole blocks for compressed formats
+	static uint64_t CalculateLevelSize(TextureFormat format, uint32_t width, uint32_t height, uint32_t level);
+
+	//Whether the device can sample the format from an optimal tiling image, BC formats are optional
+	static bool IsFormatSupported(TextureFormat format);
+private:
+	void CopyLevel(uint32_t level, const void* data, uint64_t size);
+	void RecordMipGeneration(VkCommandBuffer commandBuffer);
+	void TransitionLevels(VkCommandBuffer commandBuffer, uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout,
+		VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage);
+private:
+	TextureDescription m_Description;
+	uint32_t m_MipLevels = 1;
+
+	VkImage m_Image = VK_NULL_HANDLE;
+	VkImageView m_ImageView = VK_NULL_HANDLE;
+	VkSampler m_Sampler = VK_NULL_HANDLE;
+	MemoryAllocation m_Allocation;
+};
@@ -0,0 +1,124 @@
+#include "VkTextureLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Core/MappedFile.h"
+#include "Core/Instrumentor.h"
+
+//File layout from the KTX 2.0 specification, everything little endian
+struct Ktx2Header {
+    uint8_t Identifier[12];
+    uint32_t VkFormat;
+    uint32_t TypeSize;
+    uint32_t PixelWidth;
+    uint32_t PixelHeight;
+    uint32_t PixelDepth;
+    uint32_t LayerCount;
+    uint32_t FaceCount;
+    uint32_t LevelCount;
+    uint32_t SupercompressionScheme;
+
+    uint32_t DfdByteOffset;
+    uint32_t DfdByteLength;
+    uint32_t KvdByteOffset;
+    uint32_t KvdByteLength;
+    uint64_t SgdByteOffset;
+    uint64_t SgdByteLength;
+};
+
+struct Ktx2LevelIndex {
+    uint64_t ByteOffset;
+    uint64_t ByteLength;
+    uint64_t UncompressedByteLength;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header has to match the file layout!");
+static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index has to match the file layout!");
+
+static const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+static bool GetKtx2TextureFormat(uint32_t vkFormat, TextureFormat& format) {
+    const TextureFormat compressedFormats[] = {
+        TextureFormat::BC1, TextureFormat::BC1_SRGB, TextureFormat::BC1_RGB, TextureFormat::BC1_RGB_SRGB, TextureFormat::BC3, TextureFormat::BC3_SRGB,
+        TextureFormat::BC5, TextureFormat::BC5_SNORM, TextureFormat::BC7, TextureFormat::BC7_SRGB
+    };
+
+    for (TextureFormat compressedFormat : compressedFormats) {
+        if (static_cast<uint32_t>(GetVkTextureFormat(compressedFormat)) == vkFormat) {
+            format = compressedFormat;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::unique_ptr<Texture> TextureLoader::LoadKtx2(const std::filesystem::path& path, const SamplerDescription& sampler) {
+    PROFILE_FUNCTION();
+
+    MappedFile file(path);
+
+    Ktx2Header header;
+    memcpy(&header, file.GetRange(0, sizeof(Ktx2Header)), sizeof(Ktx2Header));
+
+    if (memcmp(header.Identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        throw std::runtime_error(path.string() + " is not a KTX2 file!");
+    }
+
+    TextureFormat format;
+    if (!GetKtx2TextureFormat(header.VkFormat, format)) {
+        throw std::runtime_error(path.string() + " is not BC1, BC3, BC5 or BC7 compressed!");
+    }
+
+    //Basis Universal and zstd/zlib supercompressed files would need transcoding or inflating first
+    if (header.SupercompressionScheme != 0) {
+        throw std::runtime_error(path.string() + " is supercompressed, which is not supported!");
+    }
+
+    if (header.PixelWidth == 0 || header.PixelHeight == 0 || header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1) {
+        throw std::runtime_error(path.string() + " is not a single 2D texture!");
+    }
+
+    if (!Texture::IsFormatSupported(format)) {
+        throw std::runtime_error("the device can't sample the compressed format of " + path.string() + "!");
+    }
+
+    //0 asks the loader to generate mips, which block compressed formats can't be blitted for
+    const uint32_t levelCount = (std::max)(header.LevelCount, 1u);
+    if (levelCount > Texture::CalculateMipLevels(header.PixelWidth, header.PixelHeight)) {
+        throw std::runtime_error(path.string() + " has more mip levels than its size allows!");
+    }
+
+    const Ktx2LevelIndex* levelIndex = reinterpret_cast<const Ktx2LevelIndex*>(
+        file.GetRange(sizeof(Ktx2Header), static_cast<uint64_t>(levelCount) * sizeof(Ktx2LevelIndex)));
+
+    //Pointers into the mapping, SetLevels copies from them directly into the staging buffer
+    std::vector<TextureLevelData> levels(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        Ktx2LevelIndex entry;
+        memcpy(&entry, &levelIndex[level], sizeof(Ktx2LevelIndex));
+
+        if (entry.ByteLength != Texture::CalculateLevelSize(format, header.PixelWidth, header.PixelHeight, level)) {
+            throw std::runtime_error(path.string() + " has a mip level of the wrong size!");
+        }
+
+        levels[level].Data = file.GetRange(entry.ByteOffset, entry.ByteLength);
+        levels[level].Size = entry.ByteLength;
+    }
+
+    TextureDescription description{};
+    description.Width = header.PixelWidth;
+    description.Height = header.PixelHeight;
+    description.Format = format;
+    description.GenerateMips = false;
+    description.MipLevels = levelCount;
+    description.Sampler = sampler;
+
+    std::unique_ptr<Texture> texture = std::make_unique<Texture>(description);
+    texture->SetLevels(levels.data(), levelCount);
+
+    return texture;
+}
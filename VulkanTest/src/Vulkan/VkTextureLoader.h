@@ -0,0 +1,14 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+
+#include "VkTexture.h"
+
+//Loads precompressed textures from disk. Files are memory mapped and every mip level is copied straight out of the
+//mapping into the staging buffer, nothing is read into an intermediate buffer first.
+class TextureLoader {
+public:
+	//2D KTX2 files in BC1, BC3, BC5 or BC7 without supercompression, with every mip level they contain.
+	//Throws when the file is malformed or the device can't sample its format.
+	static std::unique_ptr<Texture> LoadKtx2(const std::filesystem::path& path, const SamplerDescription& sampler = {});
+};
@@ -0,0 +1,79 @@
+#include "VkUniformRingBuffer.h"
+
+#include <algorithm>
+
+#include "VkDevice.h"
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void UniformRingBuffer::Init(VkDeviceSize frameSize, VkDeviceSize maxAllocationSize) {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(Device::Get().GetPhysicalDevice(), &properties);
+
+    m_Alignment = (std::max)(properties.limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+    m_MaxAllocationSize = (std::min)(maxAllocationSize, (VkDeviceSize)properties.limits.maxUniformBufferRange);
+    m_FrameSize = AlignUp(frameSize, m_Alignment);
+
+    //The binding's range reaches past the last allocation of the last region, the tail keeps that inside the buffer
+    BufferDescription bufferDescription{};
+    bufferDescription.Type = BufferType::UniformBuffer;
+    bufferDescription.MemoryType = BufferMemoryType::PersistentlyMapped;
+    bufferDescription.Size = m_FrameSize * Device::MAX_FRAMES_IN_FLIGHT + m_MaxAllocationSize;
+    m_Buffer = std::make_shared<Buffer>(bufferDescription);
+
+    DescriptorBinding binding{};
+    binding.Binding = 0;
+    binding.Type = DescriptorType::UniformBufferDynamic;
+    m_Layout = std::make_shared<DescriptorSetLayout>(std::vector<DescriptorBinding>{ binding });
+
+    for (uint32_t frame = 0; frame < Device::MAX_FRAMES_IN_FLIGHT; frame++) {
+        auto descriptorSet = std::make_unique<DescriptorSet>(m_Layout);
+        descriptorSet->WriteBuffer(0, m_Buffer->GetBuffer(), frame * m_FrameSize, m_MaxAllocationSize);
+        m_DescriptorSets.push_back(std::move(descriptorSet));
+    }
+
+    m_Frame = Device::Get().GetCurrentFrame();
+    m_Head = 0;
+}
+
+void UniformRingBuffer::Shutdown() {
+    m_DescriptorSets.clear();
+    m_Layout.reset();
+    m_Buffer.reset();
+}
+
+void UniformRingBuffer::BeginFrame() {
+    m_Frame = Device::Get().GetCurrentFrame();
+    m_Head.store(0, std::memory_order_relaxed);
+}
+
+void UniformRingBuffer::Flush() {
+    VkDeviceSize used = (std::min)(m_Head.load(std::memory_order_relaxed), m_FrameSize);
+    if (used > 0)
+        m_Buffer->Flush(m_Frame * m_FrameSize, used);
+}
+
+UniformAllocation UniformRingBuffer::Allocate(uint32_t size) {
+    if (size > m_MaxAllocationSize) {
+        throw std::runtime_error("uniform allocation is larger than the dynamic uniform binding!");
+    }
+
+    VkDeviceSize alignedSize = AlignUp(size, m_Alignment);
+    VkDeviceSize offset = m_Head.fetch_add(alignedSize, std::memory_order_relaxed);
+    if (offset + alignedSize > m_FrameSize) {
+        throw std::runtime_error("uniform ring buffer is full!");
+    }
+
+    UniformAllocation allocation{};
+    allocation.Data = m_Buffer->GetWritePointer<char>(m_Frame * m_FrameSize + offset, size);
+    allocation.DynamicOffset = static_cast<uint32_t>(offset);
+    allocation.Size = size;
+
+    return allocation;
+}
+
+void UniformRingBuffer::Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t setIndex, const UniformAllocation& allocation) const {
+    m_DescriptorSets[m_Frame]->Bind(commandBuffer, pipelineLayout, setIndex, &allocation.DynamicOffset, 1);
+}
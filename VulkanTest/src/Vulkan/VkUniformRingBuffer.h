@@ -0,0 +1,73 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+
+#include "VkBuffer.h"
+#include "VkDescriptorSet.h"
+
+struct UniformAllocation {
+	void* Data = nullptr;
+
+	//Passed to vkCmdBindDescriptorSets, relative to the current frame's part of the ring
+	uint32_t DynamicOffset = 0;
+	uint32_t Size = 0;
+};
+
+//Per frame uniform data out of one persistently mapped buffer, split into a region per frame in flight. Every region
+//has one descriptor set with a UNIFORM_BUFFER_DYNAMIC binding, allocations only differ in their dynamic offset, so
+//nothing has to be allocated or written per object. A region is reused once its frame's fence has been waited on.
+class UniformRingBuffer {
+public:
+	void Init(VkDeviceSize frameSize = DEFAULT_FRAME_SIZE, VkDeviceSize maxAllocationSize = DEFAULT_MAX_ALLOCATION_SIZE);
+	void Shutdown();
+
+	//Starts handing out the current frame's region again, only call once the frame's fence has been waited on
+	void BeginFrame();
+
+	//Makes this frame's writes visible to the GPU, before the frame is submitted
+	void Flush();
+
+	//Only while a frame is being recorded, from any recording thread. Throws once the frame's region is full.
+	UniformAllocation Allocate(uint32_t size);
+
+	//The size limit is the one Init was given, clamped to the device's, so it is checked by Allocate rather than at compile time
+	template<typename T>
+	UniformAllocation Push(const T& data) {
+		static_assert(std::is_trivially_copyable_v<T>, "uniform data is copied as raw bytes!");
+
+		UniformAllocation allocation = Allocate(sizeof(T));
+		memcpy(allocation.Data, &data, sizeof(T));
+		return allocation;
+	}
+
+	//Binds the current frame's set at setIndex with the allocation's offset
+	void Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t setIndex, const UniformAllocation& allocation) const;
+
+	//Pipelines declare this at the set index they bind the ring to, binding 0 is the dynamic uniform buffer
+	const std::shared_ptr<DescriptorSetLayout>& GetLayout() const { return m_Layout; }
+
+	VkDeviceSize GetFrameSize() const { return m_FrameSize; }
+	VkDeviceSize GetAlignment() const { return m_Alignment; }
+	VkDeviceSize GetMaxAllocationSize() const { return m_MaxAllocationSize; }
+	VkDeviceSize GetUsed() const { return m_Head.load(std::memory_order_relaxed); }
+public:
+	static const VkDeviceSize DEFAULT_FRAME_SIZE = 4ull * 1024 * 1024;
+	static const VkDeviceSize DEFAULT_MAX_ALLOCATION_SIZE = 16ull * 1024;
+private:
+	std::shared_ptr<Buffer> m_Buffer;
+	std::shared_ptr<DescriptorSetLayout> m_Layout;
+	std::vector<std::unique_ptr<DescriptorSet>> m_DescriptorSets;
+
+	VkDeviceSize m_FrameSize = 0;
+	VkDeviceSize m_MaxAllocationSize = 0;
+	VkDeviceSize m_Alignment = 256;
+
+	//Frame the region being handed out belongs to, and how much of it is used
+	uint32_t m_Frame = 0;
+	std::atomic<VkDeviceSize> m_Head = 0;
+};
@@ -2,8 +2,10 @@
 
 #include "GraphicsAPI.h"
 
-Window::Window(uint32_t width, uint32_t height, const char* name) {
-	InitWindow(width, height, name);
+Window::Window(uint32_t width, uint32_t height, const char* name, bool headless)
+	: m_Width(width), m_Height(height) {
+	if (!headless)
+		InitWindow(width, height, name);
 
 	Device::Get().Init(m_Window);
 }
@@ -11,12 +13,16 @@ Window::Window(uint32_t width, uint32_t height, const char* name) {
 Window::~Window() {
 	Device::Get().Shutdown();
 
+	if (IsHeadless())
+		return;
+
 	glfwDestroyWindow(m_Window);
 	glfwTerminate();
 }
 
 void Window::OnUpdate() {
-	glfwPollEvents();
+	if (!IsHeadless())
+		glfwPollEvents();
 }
 
 void Window::OnRender() {
@@ -24,7 +30,7 @@ void Window::OnRender() {
 }
 
 bool Window::ShouldClose() {
-	return glfwWindowShouldClose(m_Window);
+	return !IsHeadless() && glfwWindowShouldClose(m_Window);
 }
 
 void Window::InitWindow(uint32_t width, uint32_t height, const char* name) {
@@ -33,4 +39,12 @@ void Window::InitWindow(uint32_t width, uint32_t height, const char* name) {
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 #endif // Vulkan
 	m_Window = glfwCreateWindow(width, height, name, nullptr, nullptr);
+
+	glfwSetWindowUserPointer(m_Window, this);
+	glfwSetFramebufferSizeCallback(m_Window, [](GLFWwindow* window, int width, int height) {
+		Window& self = *static_cast<Window*>(glfwGetWindowUserPointer(window));
+		self.m_Width = static_cast<uint32_t>(width);
+		self.m_Height = static_cast<uint32_t>(height);
+		self.m_Resized = true;
+	});
 }
\ No newline at end of file
@@ -8,7 +8,8 @@
 
 class Window {
 public:
-	Window(uint32_t width, uint32_t height, const char* name);
+	//A headless window never touches GLFW, it only remembers the size to render at
+	Window(uint32_t width, uint32_t height, const char* name, bool headless = false);
 	~Window();
 
 	void OnUpdate();
@@ -17,8 +18,17 @@ public:
 	bool ShouldClose();
 
 	GLFWwindow* GetWindowHandle() { return m_Window; }
+	bool IsHeadless() const { return m_Window == nullptr; }
+
+	uint32_t GetWidth() const { return m_Width; }
+	uint32_t GetHeight() const { return m_Height; }
+
+	//True once after the framebuffer size changed, not every platform reports that through the swapchain
+	bool PollResized() { bool resized = m_Resized; m_Resized = false; return resized; }
 private:
 	void InitWindow(uint32_t width, uint32_t height, const char* name);
 private:
-	GLFWwindow* m_Window;
+	GLFWwindow* m_Window = nullptr;
+	uint32_t m_Width, m_Height;
+	bool m_Resized = false;
 };
\ No newline at end of file
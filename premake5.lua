@@ -26,4 +26,5 @@ group "Dependencies"
 	include "VulkanTest/vendor/GLFW"
 group ""
 
-include "VulkanTest"
\ No newline at end of file
+include "VulkanTest"
+include "Benchmark"
\ No newline at end of file
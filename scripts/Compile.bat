@@ -2,5 +2,10 @@ Pushd ..\VulkanTest\shaders
 
 %VULKAN_SDK%\Bin\glslc.exe shader.vert -o vert.spv
 %VULKAN_SDK%\Bin\glslc.exe shader.frag -o frag.spv
+%VULKAN_SDK%\Bin\glslc.exe instanced.vert -o instanced_vert.spv
+%VULKAN_SDK%\Bin\glslc.exe uniform.vert -o uniform_vert.spv
+%VULKAN_SDK%\Bin\glslc.exe push_constant.vert -o push_constant_vert.spv
+%VULKAN_SDK%\Bin\glslc.exe textured.vert -o textured_vert.spv
+%VULKAN_SDK%\Bin\glslc.exe textured.frag -o textured_frag.spv
 
 pause
\ No newline at end of file